@@ -55,6 +55,23 @@ $(call ProjectSetting,ignored_sources,*.test.cpp)
 # $(call ProjectSetting,pch,$(_pch_rules))
 $(call ProjectSetting,libs,*)
 
+# Packs a directory into an `AssetArchive`, see `tools/asset_packer.cpp`.
+# `EM_TOOL` disables the game's `main()`, same as `EM_ENABLE_TESTS` does for the tests.
+$(call Project,exe,asset-packer)
+$(call ProjectSetting,source_dirs,src $(filter-out deps/minitest/%,$(wildcard deps/*/src)))
+$(call ProjectSetting,sources,tools/asset_packer.cpp)
+$(call ProjectSetting,ignored_sources,*.test.cpp)
+$(call ProjectSetting,cxxflags,-DEM_TOOL)
+$(call ProjectSetting,libs,*)
+
+# Compresses images into `Gpu::CompressedImage`s, see `tools/texture_encoder.cpp`.
+$(call Project,exe,texture-encoder)
+$(call ProjectSetting,source_dirs,src $(filter-out deps/minitest/%,$(wildcard deps/*/src)))
+$(call ProjectSetting,sources,tools/texture_encoder.cpp)
+$(call ProjectSetting,ignored_sources,*.test.cpp)
+$(call ProjectSetting,cxxflags,-DEM_TOOL)
+$(call ProjectSetting,libs,*)
+
 $(call Project,exe,tests)
 $(call ProjectSetting,source_dirs,src $(filter-out deps/minitest/test,$(wildcard deps/*/test deps/*/src)))
 $(call ProjectSetting,sources,deps/minitest/src/main.cpp)
@@ -121,6 +138,11 @@ $(call Library,openal_soft,https://github.com/kcat/openal-soft/archive/refs/tags
   # We used to disable other backends here, but it seems our CMake isolation should make this unnecessary.
   $(call LibrarySetting,cmake_flags,-DALSOFT_EXAMPLES=FALSE -DALSOFT_UTILS=FALSE -DALSOFT_REQUIRE_SDL3=TRUE -DALSOFT_BACKEND_SDL3=TRUE)
 
+# For compiling shaders in-process, see `GlslangShaderCompiler`.
+# Disabling the optimizer, since it needs SPIRV-Tools, and the CLI tools, since we have `glslc` for that.
+$(call Library,glslang,https://github.com/KhronosGroup/glslang/archive/refs/tags/15.4.0.tar.gz)
+  $(call LibrarySetting,cmake_flags,-DENABLE_OPT=OFF -DGLSLANG_TESTS=OFF -DENABLE_GLSLANG_BINARIES=OFF -DBUILD_SHARED_LIBS=ON)
+
 $(call Library,gtl,https://github.com/greg7mdp/gtl/archive/fd759e1957e7d5c789260e87a2646cb418bd4c38.zip)
   $(call LibrarySetting,cmake_flags,-DGTL_BUILD_TESTS=OFF -DGTL_BUILD_EXAMPLES=OFF -DGTL_BUILD_BENCHMARK=OFF)# Otherwise it downloads GTest, which is nonsense.
 
@@ -6,6 +6,7 @@
 #include "gpu/command_buffer.h"
 #include "gpu/copy_pass.h"
 #include "gpu/device.h"
+#include "gpu/frame_context.h"
 #include "gpu/pipeline.h"
 #include "gpu/render_pass.h"
 #include "gpu/shader.h"
@@ -43,6 +44,7 @@ struct GameApp : App::Module
             .size = screen_size * 2,
             .min_size = screen_size,
         })
+        (Gpu::FrameContext)(frames, Gpu::FrameContext(gpu))
         (Graphics::ShaderManager)(shader_manager, gpu)
         (Gpu::Texture)(texture)
         (Graphics::Renderer2d::Resources)(renderer_resources)
@@ -70,7 +72,7 @@ struct GameApp : App::Module
         { // Load the texture.
             Gpu::CommandBuffer cmdbuf(gpu);
             Gpu::CopyPass copy_pass(cmdbuf);
-            texture = Gpu::Texture(gpu, copy_pass, Image("dummy", Filesystem::LoadedFile(fmt::format("{}assets/images/dummy.png", Filesystem::GetResourceDir()))));
+            texture = Gpu::Texture(gpu, copy_pass, Image("dummy", Filesystem::FileContents(fmt::format("{}assets/images/dummy.png", Filesystem::GetResourceDir()))));
             upscaler_resources = Graphics::PixelUpscaler::Resources(gpu, copy_pass, screen_size);
         }
 
@@ -79,10 +81,13 @@ struct GameApp : App::Module
 
     App::Action Tick() override
     {
-        Gpu::SwapchainAcquireResult swapchain = WaitAndAcquireSwapchainTextureAndCmdBuf(window, gpu);
+        shader_manager.ReloadChangedShaders();
+
+        Gpu::SwapchainAcquireResult swapchain = frames.BeginFrame(window, gpu);
         if (!swapchain)
         {
-            swapchain.cmdbuf.CancelWhenDestroyed();
+            // If `swapchain.would_block` is set, the GPU is busy (only with `--frame-pacing cpu-work`). This is where we'd do some simulation
+            //   instead of waiting. Either way we get called again right away.
             return App::Action::cont; // No draw target.
         }
 
@@ -0,0 +1,58 @@
+#include "async_creator.h"
+
+#include "gpu/device.h"
+
+#include <stdexcept>
+
+namespace em::Gpu
+{
+    namespace
+    {
+        template <typename T, typename F>
+        [[nodiscard]] AsyncObject<T> RunAsync(ThreadPool &thread_pool, F &&func)
+        {
+            if (!thread_pool)
+                throw std::logic_error("Attempt to use a null `Gpu::AsyncCreator`.");
+
+            auto shared = std::make_shared<typename AsyncObject<T>::Shared>();
+
+            thread_pool.Run([shared, func = std::forward<F>(func)]() mutable
+            {
+                try
+                {
+                    shared->SetValue(func());
+                }
+                catch (...)
+                {
+                    shared->SetException(std::current_exception());
+                }
+            });
+
+            return AsyncObject<T>(std::move(shared));
+        }
+    }
+
+    AsyncObject<Pipeline> AsyncCreator::CreatePipeline(Device &device, Pipeline::Params params)
+    {
+        return RunAsync<Pipeline>(thread_pool, [&device, params = std::move(params)]
+        {
+            return std::make_shared<Pipeline>(device, params);
+        });
+    }
+
+    AsyncObject<Shader> AsyncCreator::CreateShader(Device &device, std::string name, Shader::Stage stage, blob spirv_binary)
+    {
+        return RunAsync<Shader>(thread_pool, [&device, name = std::move(name), stage, spirv_binary = std::move(spirv_binary)]
+        {
+            return std::make_shared<Shader>(device, name, stage, spirv_binary);
+        });
+    }
+
+    AsyncObject<ComputePipeline> AsyncCreator::CreateComputePipeline(Device &device, std::string name, blob spirv_binary)
+    {
+        return RunAsync<ComputePipeline>(thread_pool, [&device, name = std::move(name), spirv_binary = std::move(spirv_binary)]
+        {
+            return std::make_shared<ComputePipeline>(device, name, spirv_binary);
+        });
+    }
+}
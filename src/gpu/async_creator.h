@@ -0,0 +1,49 @@
+#pragma once
+
+#include "em/zstring_view.h"
+#include "gpu/async_object.h"
+#include "gpu/compute_pipeline.h"
+#include "gpu/pipeline.h"
+#include "gpu/shader.h"
+#include "utils/blob.h"
+#include "utils/thread_pool.h"
+
+#include <string>
+
+namespace em::Gpu
+{
+    class Device;
+
+    // Creates pipelines and shaders on worker threads, to avoid stalling the main thread, e.g. during loading screens.
+    // This relies on SDL allowing the GPU resources to be created from any thread.
+    //
+    // Use `PipelineCache::GetAsync()` to create pipelines through the cache, then the later synchronous `PipelineCache::Get()`s will reuse them.
+    // Until a pipeline is ready, you can render with a simpler fallback pipeline, see `AsyncObject::GetOr()` and `DynamicPipeline::GetPipelineOr()`.
+    class AsyncCreator
+    {
+        ThreadPool thread_pool;
+
+      public:
+        constexpr AsyncCreator() {}
+
+        // If `num_threads` is zero, uses the number of CPU cores.
+        explicit AsyncCreator(int num_threads) : thread_pool(num_threads) {}
+
+        // Destroying this waits for all pending objects to be created.
+
+        [[nodiscard]] explicit operator bool() const {return bool(thread_pool);}
+
+        // The device must not be moved or destroyed until the pipeline is ready.
+        // The shaders must stay alive and must not be modified (e.g. reloaded) until the pipeline is ready.
+        [[nodiscard]] AsyncObject<Pipeline> CreatePipeline(Device &device, Pipeline::Params params);
+
+        // The device must not be moved or destroyed until the shader is ready.
+        [[nodiscard]] AsyncObject<Shader> CreateShader(Device &device, std::string name, Shader::Stage stage, blob spirv_binary);
+
+        // The device must not be moved or destroyed until the pipeline is ready.
+        [[nodiscard]] AsyncObject<ComputePipeline> CreateComputePipeline(Device &device, std::string name, blob spirv_binary);
+
+        // Blocks until all the pending objects are ready.
+        void WaitUntilIdle() {thread_pool.WaitUntilIdle();}
+    };
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace em::Gpu
+{
+    // A handle to a GPU object that's being created on another thread, see `AsyncCreator`.
+    // This is similar to `Fence` (and `std::future`): you can poll it with `IsReady()`, or block with `Wait()`. But it also holds the resulting object.
+    // Unlike `std::future`, this can be copied, and the copies share the result.
+    template <typename T>
+    class AsyncObject
+    {
+      public:
+        // This is shared between the handles and the thread that creates the object.
+        struct Shared
+        {
+            std::mutex mutex;
+            std::condition_variable became_ready;
+
+            bool ready = false;
+            // Exactly one of those two is set when `ready` is true.
+            std::shared_ptr<T> value;
+            std::exception_ptr exception;
+
+            void SetValue(std::shared_ptr<T> new_value)
+            {
+                {
+                    std::lock_guard lock(mutex);
+                    value = std::move(new_value);
+                    ready = true;
+                }
+                became_ready.notify_all();
+            }
+
+            void SetException(std::exception_ptr new_exception)
+            {
+                {
+                    std::lock_guard lock(mutex);
+                    exception = std::move(new_exception);
+                    ready = true;
+                }
+                became_ready.notify_all();
+            }
+        };
+
+      private:
+        std::shared_ptr<Shared> shared;
+
+        void ThrowIfNull() const
+        {
+            if (!shared)
+                throw std::logic_error("Attempt to use a null `Gpu::AsyncObject`.");
+        }
+
+      public:
+        constexpr AsyncObject() {}
+
+        // Makes a handle that's already ready. `value` must not be null.
+        explicit AsyncObject(std::shared_ptr<T> value)
+            : shared(std::make_shared<Shared>())
+        {
+            shared->value = std::move(value);
+            shared->ready = true;
+        }
+
+        // Makes a handle that becomes ready when `Shared::SetValue()` or `Shared::SetException()` is called.
+        explicit AsyncObject(std::shared_ptr<Shared> shared) : shared(std::move(shared)) {}
+
+        [[nodiscard]] explicit operator bool() const {return bool(shared);}
+
+        // Doesn't block, returns true if the object was created or if the creation has failed.
+        [[nodiscard]] bool IsReady() const
+        {
+            ThrowIfNull();
+            std::lock_guard lock(shared->mutex);
+            return shared->ready;
+        }
+
+        // Blocks until the object is ready. Rethrows the exception if the creation has failed.
+        void Wait() const
+        {
+            ThrowIfNull();
+            std::unique_lock lock(shared->mutex);
+            shared->became_ready.wait(lock, [&]{return shared->ready;});
+            if (shared->exception)
+                std::rethrow_exception(shared->exception);
+        }
+
+        // Blocks until the object is ready and returns it. Rethrows the exception if the creation has failed.
+        [[nodiscard]] const std::shared_ptr<T> &Get() const
+        {
+            Wait();
+            return shared->value; // This doesn't change after becoming ready, so we don't need the lock.
+        }
+
+        // Doesn't block. Returns the object if it's ready, or `fallback` otherwise. Rethrows the exception if the creation has failed.
+        [[nodiscard]] T &GetOr(T &fallback) const
+        {
+            if (!IsReady())
+                return fallback;
+            return *Get();
+        }
+    };
+}
@@ -1,6 +1,7 @@
 #include "buffer.h"
 
 #include "gpu/device.h"
+#include "gpu/staging_uploader.h"
 #include "gpu/transfer_buffer.h"
 
 #include <fmt/format.h>
@@ -32,6 +33,22 @@ namespace em::Gpu
         tb.ApplyToBuffer(pass, *this);
     }
 
+    Buffer::Buffer(Device &device, StagingUploader &uploader, const_byte_view data, Usage usage)
+        : Buffer(device, std::uint32_t(data.size()), usage)
+    {
+        uploader.UploadToBuffer(device, data, *this);
+    }
+
+    Buffer::Buffer(ViewExternalHandle, SDL_GPUDevice *device, SDL_GPUBuffer *handle)
+    {
+        if (handle)
+        {
+            state.device = device;
+            state.buffer = handle;
+            state.owns_buffer = false;
+        }
+    }
+
     Buffer::Buffer(Buffer &&other) noexcept
         : state(std::move(other.state))
     {
@@ -46,7 +63,7 @@ namespace em::Gpu
 
     Buffer::~Buffer()
     {
-        if (state.buffer)
+        if (state.buffer && state.owns_buffer)
             SDL_ReleaseGPUBuffer(state.device, state.buffer);
     }
 }
@@ -11,6 +11,7 @@ namespace em::Gpu
 {
     class CopyPass;
     class Device;
+    class StagingUploader;
 
     // A texture.
     class Buffer
@@ -22,6 +23,8 @@ namespace em::Gpu
             SDL_GPUDevice *device = nullptr;
 
             SDL_GPUBuffer *buffer = nullptr;
+
+            bool owns_buffer = true;
         };
         State state;
 
@@ -57,6 +60,12 @@ namespace em::Gpu
         Buffer(Device &device, std::uint32_t size, Usage usage = Usage::vertex);
         // A helper constructor that creates a buffer and immediately fills it using a temporary transfer buffer.
         Buffer(Device &device, CopyPass &pass, const_byte_view data, Usage usage = Usage::vertex);
+        // Same, but queues the upload into `uploader`, to be batched with other uploads. The buffer must not be used until `uploader.Flush()`.
+        Buffer(Device &device, StagingUploader &uploader, const_byte_view data, Usage usage = Usage::vertex);
+
+        struct ViewExternalHandle {explicit ViewExternalHandle() = default;};
+        // Put an existing handle into a buffer, and don't free it when destroyed.
+        Buffer(ViewExternalHandle, SDL_GPUDevice *device, SDL_GPUBuffer *handle);
 
         Buffer(Buffer &&other) noexcept;
         Buffer &operator=(Buffer other) noexcept;
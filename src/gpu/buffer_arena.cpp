@@ -0,0 +1,132 @@
+#include "buffer_arena.h"
+
+#include "gpu/copy_pass.h"
+#include "gpu/device.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace em::Gpu
+{
+    BufferArena::BufferArena(const Params &params)
+    {
+        if (params.page_size == 0)
+            throw std::logic_error("The page size of a `Gpu::BufferArena` can't be zero.");
+
+        state.params = params;
+    }
+
+    BufferArena::Range BufferArena::Allocate(Device &device, const_byte_view data, std::uint32_t alignment)
+    {
+        if (state.params.page_size == 0)
+            throw std::logic_error("Attempt to use a null `Gpu::BufferArena`.");
+        if (data.empty())
+            throw std::logic_error("Attempt to allocate an empty range in a `Gpu::BufferArena`.");
+        // The GPU buffer sizes and offsets are 32-bit. This also covers the offsets in the staging buffer.
+        if (data.size() > std::numeric_limits<std::uint32_t>::max() - state.pending_data.size())
+            throw std::runtime_error(fmt::format("Unable to allocate {} bytes in a `Gpu::BufferArena`, the data doesn't fit in 4 GiB along with the {} bytes waiting for `Flush()`.", data.size(), state.pending_data.size()));
+
+        std::uint32_t size = std::uint32_t(data.size());
+
+        Page *page = nullptr;
+        std::uint32_t offset = 0;
+
+        // Try the existing pages first.
+        for (const auto &existing_page : state.pages)
+        {
+            if (existing_page->dedicated)
+                continue;
+            if (auto existing_offset = existing_page->allocator.Allocate(size, alignment))
+            {
+                page = existing_page.get();
+                offset = *existing_offset;
+                break;
+            }
+        }
+
+        if (!page)
+        {
+            // Give the allocations that don't fit into a page their own buffer. Also account for the worst case alignment padding.
+            bool dedicated = std::uint64_t(size) + alignment - 1 > state.params.page_size;
+            std::uint32_t page_size = dedicated ? size : state.params.page_size;
+
+            auto new_page = std::make_unique<Page>();
+            new_page->buffer = Buffer(device, page_size, state.params.usage);
+            new_page->allocator = RangeAllocator(page_size);
+            new_page->dedicated = dedicated;
+
+            // The first allocation in a page is at offset zero, so it's always aligned.
+            offset = new_page->allocator.Allocate(size, alignment).value();
+            page = state.pages.emplace_back(std::move(new_page)).get();
+        }
+
+        // Queue the upload.
+        state.pending_uploads.push_back({
+            .target = &page->buffer,
+            .target_offset = offset,
+            .source_offset = std::uint32_t(state.pending_data.size()),
+            .size = size,
+        });
+        state.pending_data.insert(state.pending_data.end(), data.begin(), data.end());
+
+        // Grow the staging buffer now, while we have the device.
+        if (state.pending_data.size() > state.staging.Size())
+            state.staging = TransferBuffer(device, std::max(std::uint32_t(state.pending_data.size()), state.staging.Size() * 2));
+
+        return {.buffer = &page->buffer, .byte_offset = offset, .size = size};
+    }
+
+    void BufferArena::Free(const Range &range)
+    {
+        auto iter = std::find_if(state.pages.begin(), state.pages.end(), [&](const auto &page){return &page->buffer == range.buffer;});
+        if (iter == state.pages.end())
+            throw std::logic_error("Attempt to free a range that wasn't allocated by this `Gpu::BufferArena`.");
+
+        // Drop the pending upload to this range, if any. Otherwise it could overwrite a newer allocation, or target a destroyed buffer.
+        std::erase_if(state.pending_uploads, [&](const PendingUpload &upload)
+        {
+            return upload.target == range.buffer && upload.target_offset == range.byte_offset;
+        });
+
+        Page &page = **iter;
+        page.allocator.Free(range.byte_offset);
+
+        // SDL destroys the buffer lazily, so this is fine even if it's still in use.
+        if (page.dedicated)
+            state.pages.erase(iter);
+    }
+
+    void BufferArena::Flush(CopyPass &pass)
+    {
+        if (state.pending_uploads.empty())
+        {
+            state.pending_data.clear();
+            return;
+        }
+
+        { // Fill the staging buffer. This cycles it, so the previous flush can still be in flight.
+            TransferBuffer::Mapping mapping = state.staging.Map();
+            std::memcpy(mapping.AsRangeOf<unsigned char>().data(), state.pending_data.data(), state.pending_data.size());
+        }
+
+        // Don't cycle the targets, that would discard the other ranges in them.
+        for (const PendingUpload &upload : state.pending_uploads)
+            state.staging.ApplyToBuffer(pass, upload.source_offset, *upload.target, upload.target_offset, upload.size, /*cycle=*/false);
+
+        state.pending_uploads.clear();
+        state.pending_data.clear();
+    }
+
+    std::size_t BufferArena::UsedBytes() const
+    {
+        std::size_t ret = 0;
+        for (const auto &page : state.pages)
+            ret += page->allocator.UsedBytes();
+        return ret;
+    }
+}
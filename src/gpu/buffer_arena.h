@@ -0,0 +1,119 @@
+#pragma once
+
+#include "gpu/buffer.h"
+#include "gpu/render_pass.h"
+#include "gpu/transfer_buffer.h"
+#include "utils/byte_view.h"
+#include "utils/range_allocator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace em::Gpu
+{
+    class CopyPass;
+    class Device;
+
+    // Suballocates many small static meshes out of a few large buffers, instead of creating a dedicated `Buffer` for each of them.
+    // This reduces the number of SDL allocations, and lets you draw several meshes without rebinding the buffer (if they happen to land in the same page).
+    //
+    // `Allocate()` only copies the data to the CPU memory. Call `Flush()` once after allocating a bunch of meshes to upload them all at once,
+    //   through a single transfer buffer. The ranges must not be drawn from before that.
+    // The uploads don't cycle the buffers (that would discard the other meshes), so don't `Free()` a range and reuse it while the GPU
+    //   can still be drawing from it. Either free between levels, or delay it with `FrameContext::DeferDestruction()` or similar.
+    class BufferArena
+    {
+      public:
+        struct Params
+        {
+            // The size of each underlying buffer. Larger allocations get their own dedicated buffers.
+            std::uint32_t page_size = 4 << 20;
+
+            // Vertices and indices can share the buffers.
+            Buffer::Usage usage = Buffer::Usage::vertex | Buffer::Usage::index;
+        };
+
+        // A range in one of the buffers.
+        struct Range
+        {
+            Buffer *buffer = nullptr;
+            std::uint32_t byte_offset = 0;
+            std::uint32_t size = 0;
+
+            [[nodiscard]] explicit operator bool() const {return bool(buffer);}
+
+            // Those are for `RenderPass::BindVertexBuffers()` and `RenderPass::BindIndexBuffer()`.
+            [[nodiscard]] RenderPass::VertexBuffer AsVertexBuffer() const {return {.buffer = buffer, .byte_offset = byte_offset};}
+            [[nodiscard]] RenderPass::IndexBuffer AsIndexBuffer(RenderPass::IndexSize index_size) const {return {.buffer = buffer, .byte_offset = byte_offset, .index_size = index_size};}
+        };
+
+      private:
+        struct Page
+        {
+            Buffer buffer;
+            RangeAllocator allocator;
+
+            // If true, this page was created for a single large allocation, and is destroyed when it's freed.
+            bool dedicated = false;
+        };
+
+        struct PendingUpload
+        {
+            Buffer *target = nullptr;
+            std::uint32_t target_offset = 0;
+            std::uint32_t source_offset = 0; // In `pending_data`.
+            std::uint32_t size = 0;
+        };
+
+        struct State
+        {
+            Params params;
+
+            // Stored by pointer, since `Range`s point to the buffers.
+            std::vector<std::unique_ptr<Page>> pages;
+
+            // The data waiting for `Flush()`.
+            std::vector<unsigned char> pending_data;
+            std::vector<PendingUpload> pending_uploads;
+
+            // This is reused between the flushes, and grows as needed.
+            TransferBuffer staging;
+        };
+        State state;
+
+      public:
+        BufferArena() {}
+
+        explicit BufferArena(const Params &params);
+
+        BufferArena(BufferArena &&other) noexcept
+            : state(std::move(other.state))
+        {
+            other.state = {};
+        }
+        BufferArena &operator=(BufferArena other) noexcept
+        {
+            std::swap(state, other.state);
+            return *this;
+        }
+
+        // Allocates a range and queues `data` to be uploaded to it by the next `Flush()`.
+        // `alignment` applies to the offset in the buffer. Use the vertex size for vertices (to be able to use `vertex_offset` when drawing),
+        //   and the index size for indices.
+        // Throws if `data` is empty, or if the data waiting for `Flush()` would exceed 4 GiB.
+        [[nodiscard]] Range Allocate(Device &device, const_byte_view data, std::uint32_t alignment = 1);
+
+        // Frees a range returned by `Allocate()`. See the comment on the class about synchronization.
+        void Free(const Range &range);
+
+        // Uploads everything queued by `Allocate()`.
+        void Flush(CopyPass &pass);
+
+        // The number of underlying buffers, including the dedicated ones.
+        [[nodiscard]] std::size_t NumPages() const {return state.pages.size();}
+        // The sum of used bytes in all pages, including the alignment padding.
+        [[nodiscard]] std::size_t UsedBytes() const;
+    };
+}
@@ -41,6 +41,8 @@ namespace em::Gpu
         {
             if (state.cancel_when_destroyed || state.num_active_exceptions < std::uncaught_exceptions())
             {
+                if (state.output_cancelled)
+                    *state.output_cancelled = true;
                 if (!SDL_CancelGPUCommandBuffer(state.buffer))
                     throw std::runtime_error(fmt::format("Unable to cancel a GPU command buffer: {}", SDL_GetError()));
             }
@@ -68,6 +70,11 @@ namespace em::Gpu
             state.cancel_when_destroyed = true;
     }
 
+    void CommandBuffer::ReportCancellationTo(bool *flag)
+    {
+        state.output_cancelled = flag;
+    }
+
     Texture CommandBuffer::WaitAndAcquireSwapchainTexture(Window &window)
     {
         // Note that this never needs freeing, so we don't really care what the value is on failure.
@@ -81,6 +88,18 @@ namespace em::Gpu
         return Texture(Texture::ViewExternalHandle{}, state.device, texture, size.to<int>().to_vec3(1), window.GetSwapchainTextureFormat());
     }
 
+    Texture CommandBuffer::TryAcquireSwapchainTexture(Window &window)
+    {
+        SDL_GPUTexture *texture = nullptr;
+
+        vec2<Uint32> size;
+
+        if (!SDL_AcquireGPUSwapchainTexture(state.buffer, window.Handle(), &texture, &size.x, &size.y))
+            throw std::runtime_error(fmt::format("Unable to acquire a GPU swapchain texture: {}", SDL_GetError()));
+
+        return Texture(Texture::ViewExternalHandle{}, state.device, texture, size.to<int>().to_vec3(1), window.GetSwapchainTextureFormat());
+    }
+
     SwapchainAcquireResult WaitAndAcquireSwapchainTextureAndCmdBuf(Window &window, Device &device, Fence *output_fence)
     {
         SwapchainAcquireResult ret;
@@ -93,4 +112,19 @@ namespace em::Gpu
         }
         return ret;
     }
+
+    SwapchainAcquireResult TryAcquireSwapchainTextureAndCmdBuf(Window &window, Device &device, Fence *output_fence)
+    {
+        SwapchainAcquireResult ret;
+        ret.cmdbuf = CommandBuffer(device, output_fence);
+        ret.texture = ret.cmdbuf.TryAcquireSwapchainTexture(window);
+        if (!ret.texture)
+        {
+            ret.cmdbuf.CancelWhenDestroyed();
+            ret.cmdbuf = {};
+            // SDL returns null in both cases, so check the window flags to tell them apart.
+            ret.would_block = !(SDL_GetWindowFlags(window.Handle()) & SDL_WINDOW_MINIMIZED);
+        }
+        return ret;
+    }
 }
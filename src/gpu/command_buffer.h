@@ -36,6 +36,9 @@ namespace em::Gpu
             // When submitting, we'll fill this fence.
             // We have to rely on it staying alive until then.
             Fence *output_fence = nullptr;
+
+            // If not null, this is set to true when the buffer is cancelled instead of being submitted. See `ReportCancellationTo()`.
+            bool *output_cancelled = nullptr;
         };
         State state;
 
@@ -43,6 +46,7 @@ namespace em::Gpu
         constexpr CommandBuffer() {}
 
         // If the `output_fence` is specified, will set it during destruction if we're not cancelling.
+        // If you submit a buffer every frame, consider getting the fences from a `FencePool`.
         // We have to set the fence pointer beforehand, instead of having an "execute" function returning it, because all of our passes use destructors
         //   to end the actual passes, and that would cause order conflicts if command lists were instead submitted by function calls.
         CommandBuffer(Device &device, Fence *output_fence = nullptr);
@@ -64,15 +68,24 @@ namespace em::Gpu
         // SDL docs say that it's an error to do this after acquiring the swapchain texture.
         void CancelWhenDestroyed();
 
+        // If the buffer gets cancelled (explicitly or because of an exception), sets `*flag` to true when destroyed. `*flag` must stay alive until then.
+        // This is for whoever tracks the `output_fence`, so they can tell a cancelled buffer from one that's still being recorded.
+        void ReportCancellationTo(bool *flag);
+
 
         // Prefer the higher-level `WaitAndAcquireSwapchainTextureAndCmdBuf()` free function declared below.
         // Get a temporary texture that represents the window.
-        // Blocks if there are too many frames in flight. There's a version that doesn't block and returns null, but we don't expose that at the moment.
+        // Blocks if there are too many frames in flight. See `TryAcquireSwapchainTexture()` for a version that doesn't block.
         // CAN RETURN NULL if the window is minimized. Don't render anything in that case.
         // If this return null, you should probably call `CancelWhenDestroyed()` and then do nothing else.
         // The docs say you can't cancel after acquiring the texture, but so far my understanding is that it applies only to SUCCESSFULLY acquiring it.
         // This seems to never return null for me on Linux on XFCE, but it does return null in Wine, and there cancelling works fine.
         [[nodiscard]] Texture WaitAndAcquireSwapchainTexture(Window &window);
+
+        // Same as `WaitAndAcquireSwapchainTexture()`, but doesn't block. Instead returns null if there are too many frames in flight
+        //   (see `SDL_SetGPUAllowedFramesInFlight()`), then you can do some other work and try again later.
+        // Also returns null if the window is minimized, like the blocking version.
+        [[nodiscard]] Texture TryAcquireSwapchainTexture(Window &window);
     };
 
     struct SwapchainAcquireResult
@@ -80,6 +93,10 @@ namespace em::Gpu
         CommandBuffer cmdbuf;
         Texture texture;
 
+        // Only set by the non-blocking functions. If true, the texture wasn't acquired because too many frames are in flight (as opposed to the window being minimized).
+        // Do some other work (e.g. simulation) and try again.
+        bool would_block = false;
+
         [[nodiscard]] explicit operator bool() const
         {
             assert(bool(cmdbuf) == bool(texture));
@@ -92,4 +109,7 @@ namespace em::Gpu
     // CAN RETURN NULL if the window is minimized. Don't render anything in that case.
     // This seems to never return null for me on Linux on XFCE, but it does return null in Wine, and there cancelling works fine.
     [[nodiscard]] SwapchainAcquireResult WaitAndAcquireSwapchainTextureAndCmdBuf(Window &window, Device &device, Fence *output_fence = nullptr);
+
+    // Same as `WaitAndAcquireSwapchainTextureAndCmdBuf()`, but doesn't block. If it returns null, check `.would_block` to see why.
+    [[nodiscard]] SwapchainAcquireResult TryAcquireSwapchainTextureAndCmdBuf(Window &window, Device &device, Fence *output_fence = nullptr);
 }
@@ -0,0 +1,234 @@
+#include "compressed_image.h"
+
+#include "gpu/device.h"
+#include "gpu/staging_uploader.h"
+
+#include <fmt/format.h>
+#include <stb_dxt.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+namespace em::Gpu
+{
+    namespace
+    {
+        // We just `memcpy` the structs to and from the file.
+        static_assert(std::endian::native == std::endian::little, "The compressed images assume a little-endian CPU.");
+        static_assert(sizeof(CompressedImage::Header) == 32);
+        static_assert(sizeof(CompressedImage::LevelEntry) == 16);
+
+        // The block data of every level starts at a multiple of this, relative to the start of the file.
+        constexpr std::size_t level_alignment = 16;
+
+        [[nodiscard]] std::size_t AlignUp(std::size_t value, std::size_t alignment)
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        // D3D requires the top mipmap level of those to have a size that's a multiple of the block size.
+        [[nodiscard]] bool IsBcFormat(SDL_GPUTextureFormat format)
+        {
+            switch (format)
+            {
+              case SDL_GPU_TEXTUREFORMAT_BC1_RGBA_UNORM:
+              case SDL_GPU_TEXTUREFORMAT_BC2_RGBA_UNORM:
+              case SDL_GPU_TEXTUREFORMAT_BC3_RGBA_UNORM:
+              case SDL_GPU_TEXTUREFORMAT_BC4_R_UNORM:
+              case SDL_GPU_TEXTUREFORMAT_BC5_RG_UNORM:
+              case SDL_GPU_TEXTUREFORMAT_BC7_RGBA_UNORM:
+              case SDL_GPU_TEXTUREFORMAT_BC6H_RGB_FLOAT:
+              case SDL_GPU_TEXTUREFORMAT_BC6H_RGB_UFLOAT:
+              case SDL_GPU_TEXTUREFORMAT_BC1_RGBA_UNORM_SRGB:
+              case SDL_GPU_TEXTUREFORMAT_BC2_RGBA_UNORM_SRGB:
+              case SDL_GPU_TEXTUREFORMAT_BC3_RGBA_UNORM_SRGB:
+              case SDL_GPU_TEXTUREFORMAT_BC7_RGBA_UNORM_SRGB:
+                return true;
+              default:
+                return false;
+            }
+        }
+
+        // Downscales the image 2x, with a box filter. The odd sizes are handled by clamping the coordinates.
+        [[nodiscard]] Image Downscale(const Image &image)
+        {
+            const ivec2 size = image.pixels.size();
+            Image ret(ivec2(std::max(1, size.x / 2), std::max(1, size.y / 2)));
+
+            for (int y = 0; y < ret.pixels.size().y; y++)
+            for (int x = 0; x < ret.pixels.size().x; x++)
+            {
+                ivec4 sum;
+                for (int dy = 0; dy < 2; dy++)
+                for (int dx = 0; dx < 2; dx++)
+                    sum += image.pixels[ivec2(std::min(x * 2 + dx, size.x - 1), std::min(y * 2 + dy, size.y - 1))].to<int>();
+                ret.pixels[ivec2(x, y)] = ((sum + 2) / 4).to<unsigned char>();
+            }
+
+            return ret;
+        }
+
+        // Compresses one mipmap level. The partial blocks at the edges are padded by repeating the last row and column.
+        void EncodeLevel(const Image &image, const CompressedImage::EncodeParams &params, std::vector<unsigned char> &output)
+        {
+            const bool alpha = params.format == CompressedImage::EncodeFormat::bc3;
+            const std::size_t block_bytes = alpha ? 16 : 8;
+            const int mode = params.high_quality ? STB_DXT_HIGHQUAL : STB_DXT_NORMAL;
+
+            const ivec2 size = image.pixels.size();
+            const ivec2 num_blocks = (size + 3) / 4;
+
+            std::size_t pos = output.size();
+            output.resize(pos + std::size_t(num_blocks.x) * std::size_t(num_blocks.y) * block_bytes);
+
+            std::array<u8vec4, 16> block_pixels;
+            for (int by = 0; by < num_blocks.y; by++)
+            for (int bx = 0; bx < num_blocks.x; bx++)
+            {
+                for (int y = 0; y < 4; y++)
+                for (int x = 0; x < 4; x++)
+                    block_pixels[std::size_t(y * 4 + x)] = image.pixels[ivec2(std::min(bx * 4 + x, size.x - 1), std::min(by * 4 + y, size.y - 1))];
+
+                stb_compress_dxt_block(output.data() + pos, reinterpret_cast<const unsigned char *>(block_pixels.data()), alpha, mode);
+                pos += block_bytes;
+            }
+        }
+    }
+
+    CompressedImage::CompressedImage(std::string_view name, const blob_or_file &data)
+    {
+        auto Fail = [&](std::string_view message)
+        {
+            throw std::runtime_error(fmt::format("Invalid compressed image `{}`: {}", name, message));
+        };
+
+        Header header;
+        if (data.size() < sizeof(header))
+            Fail("It's too small to contain a header.");
+        std::memcpy(&header, data.data(), sizeof(header));
+
+        if (std::memcmp(header.magic, Header::expected_magic, sizeof(header.magic)) != 0)
+            Fail("It's not a compressed image.");
+        if (header.version != Header::current_version)
+            Fail(fmt::format("Unsupported version {}, expected {}.", header.version, Header::current_version));
+        if (header.width == 0 || header.height == 0 || header.width > 1u << 16 || header.height > 1u << 16)
+            Fail(fmt::format("Invalid size {}x{}.", header.width, header.height));
+        if (header.num_levels == 0 || header.num_levels > std::uint32_t(std::bit_width(std::max(header.width, header.height))))
+            Fail(fmt::format("Invalid number of mipmap levels {}.", header.num_levels));
+        if ((data.size() - sizeof(header)) / sizeof(LevelEntry) < header.num_levels)
+            Fail("The level table is truncated.");
+
+        const auto format = SDL_GPUTextureFormat(header.format);
+        // This returns 0 for the unknown formats.
+        if (SDL_CalculateGPUTextureFormatSize(format, 1, 1, 1) == 0)
+            Fail(fmt::format("Unknown texture format {}.", header.format));
+        if (IsBcFormat(format) && (header.width % 4 != 0 || header.height % 4 != 0))
+            Fail(fmt::format("The size {}x{} isn't a multiple of 4, which the block-compressed formats require.", header.width, header.height));
+
+        state.levels.reserve(header.num_levels);
+
+        for (std::uint32_t i = 0; i < header.num_levels; i++)
+        {
+            LevelEntry entry;
+            std::memcpy(&entry, data.data() + sizeof(header) + sizeof(entry) * i, sizeof(entry));
+
+            if (entry.byte_offset > data.size() || entry.size > data.size() - entry.byte_offset)
+                Fail(fmt::format("The mipmap level {} is out of bounds.", i));
+
+            // This accounts for the partial blocks at the edges, so the smallest levels still take a whole block.
+            const std::uint32_t expected_size = SDL_CalculateGPUTextureFormatSize(format, std::max(1u, header.width >> i), std::max(1u, header.height >> i), 1);
+            if (entry.size != expected_size)
+                Fail(fmt::format("The mipmap level {} has size {}, but expected {} for this format.", i, entry.size, expected_size));
+
+            state.levels.push_back(data.Slice(std::size_t(entry.byte_offset), std::size_t(entry.size)));
+        }
+
+        state.format = format;
+        state.size = ivec2(int(header.width), int(header.height));
+    }
+
+    bool CompressedImage::Matches(const_byte_view data)
+    {
+        return data.size() >= sizeof(Header) && std::memcmp(data.data(), Header::expected_magic, sizeof(Header::expected_magic)) == 0;
+    }
+
+    bool CompressedImage::IsSupported(Device &device, Texture::UsageFlags usage) const
+    {
+        return SDL_GPUTextureSupportsFormat(device.Handle(), state.format, SDL_GPU_TEXTURETYPE_2D, SDL_GPUTextureUsageFlags(usage));
+    }
+
+    Texture CompressedImage::CreateTexture(Device &device, StagingUploader &uploader, Texture::UsageFlags usage) const
+    {
+        if (!*this)
+            throw std::logic_error("Attempt to use a null `Gpu::CompressedImage`.");
+        if (!IsSupported(device, usage))
+            throw std::runtime_error(fmt::format("This GPU doesn't support the texture format {} of a compressed image.", std::uint32_t(state.format)));
+
+        Texture ret(device, Texture::Params{
+            .format = state.format,
+            .usage = usage,
+            .size = state.size.to_vec3(1),
+            .num_mipmap_levels = NumLevels(),
+        });
+
+        // `ApplyToTexture()` uses the mipmap size as the region, and SDL rounds up the rows to whole blocks on its own, so nothing else is needed here.
+        // No cycling: after the first level, the texture is already used by the pending copy, so cycling would discard the levels uploaded before.
+        //   And the texture was just created, so there's nothing to preserve by cycling it anyway.
+        for (int i = 0; i < NumLevels(); i++)
+            uploader.UploadToTexture(device, state.levels[std::size_t(i)], ret, {.mipmap_layer = std::uint32_t(i), .cycle = false});
+
+        return ret;
+    }
+
+    std::vector<unsigned char> CompressedImage::Encode(const Image &image, const EncodeParams &params)
+    {
+        const ivec2 size = image.pixels.size();
+        if (size.x <= 0 || size.y <= 0)
+            throw std::logic_error("Attempt to encode an empty image.");
+        if (size.x % 4 != 0 || size.y % 4 != 0)
+            throw std::runtime_error(fmt::format("Can't compress a {}x{} image, the size must be a multiple of 4 for the block-compressed formats.", size.x, size.y));
+
+        // stb_dxt only produces the opaque 4-color BC1 blocks, never the 1-bit alpha ones, so the transparency would be silently lost.
+        if (params.format == EncodeFormat::bc1)
+        {
+            for (const u8vec4 &pixel : image.pixels.as_flat_array())
+            {
+                if (pixel.a() != 255)
+                    throw std::runtime_error("BC1 can't store transparent pixels, and this image has some. Use BC3 instead.");
+            }
+        }
+
+        const int num_levels = params.generate_mipmaps ? std::bit_width(std::uint32_t(std::max(size.x, size.y))) : 1;
+
+        Header header;
+        std::memcpy(header.magic, Header::expected_magic, sizeof(header.magic));
+        header.version = Header::current_version;
+        header.format = params.format == EncodeFormat::bc3 ? SDL_GPU_TEXTUREFORMAT_BC3_RGBA_UNORM : SDL_GPU_TEXTUREFORMAT_BC1_RGBA_UNORM;
+        header.width = std::uint32_t(size.x);
+        header.height = std::uint32_t(size.y);
+        header.num_levels = std::uint32_t(num_levels);
+
+        std::vector<LevelEntry> entries(std::size_t(num_levels));
+
+        std::vector<unsigned char> ret(sizeof(header) + sizeof(LevelEntry) * entries.size()); // Write the level table at the end, when we know the offsets.
+
+        Image mipmap; // Null for the first level, which is `image` itself.
+        for (int i = 0; i < num_levels; i++)
+        {
+            if (i > 0)
+                mipmap = Downscale(i == 1 ? image : mipmap);
+
+            ret.resize(AlignUp(ret.size(), level_alignment));
+            entries[std::size_t(i)].byte_offset = ret.size();
+            EncodeLevel(i == 0 ? image : mipmap, params, ret);
+            entries[std::size_t(i)].size = ret.size() - entries[std::size_t(i)].byte_offset;
+        }
+
+        std::memcpy(ret.data(), &header, sizeof(header));
+        std::memcpy(ret.data() + sizeof(header), entries.data(), sizeof(LevelEntry) * entries.size());
+        return ret;
+    }
+}
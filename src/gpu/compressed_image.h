@@ -0,0 +1,130 @@
+#pragma once
+
+#include "em/math/vector.h"
+#include "gpu/texture.h"
+#include "utils/blob.h"
+#include "utils/byte_view.h"
+#include "utils/filesystem.h"
+#include "utils/image.h"
+
+#include <SDL3/SDL_gpu.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace em::Gpu
+{
+    class Device;
+    class StagingUploader;
+
+    // Pre-compressed texture data (BC1, BC3, BC7, ASTC, ...) with a mipmap chain, in our own container format.
+    // Block-compressed textures take 4-8 times less VRAM and upload bandwidth than RGBA8, and the GPU samples them directly.
+    //
+    // Make those offline with `Encode()` (or with the `texture-encoder` tool, see `tools/texture_encoder.cpp`), then load them with the constructor
+    //   and upload with `CreateTexture()`. Loading doesn't copy anything, the mipmaps are slices of the blob.
+    // Not all GPUs support all formats (desktops have BC, mobile has ASTC), so check `IsSupported()` and keep an uncompressed fallback if needed.
+    // The size of BC textures must be a multiple of 4 (D3D requires this for the top mipmap level), the smaller mipmaps can be anything.
+    //
+    // The format, all integers are little-endian:
+    //   `Header`
+    //   `Header::num_levels` copies of `LevelEntry`.
+    //   The block data of each mipmap level, tightly packed, the rows and columns rounded up to whole blocks.
+    class CompressedImage
+    {
+      public:
+        struct Header
+        {
+            static constexpr char expected_magic[8] = {'E', 'M', 'G', 'P', 'U', 'T', 'E', 'X'};
+            static constexpr std::uint32_t current_version = 1;
+
+            char magic[8]{};
+            std::uint32_t version = 0;
+            // An `SDL_GPUTextureFormat`. Its values are a part of the SDL ABI, so they're safe to store.
+            std::uint32_t format = 0;
+            std::uint32_t width = 0;
+            std::uint32_t height = 0;
+            std::uint32_t num_levels = 0;
+            std::uint32_t reserved = 0;
+        };
+
+        struct LevelEntry
+        {
+            // Relative to the start of the data.
+            std::uint64_t byte_offset = 0;
+            std::uint64_t size = 0;
+        };
+
+      private:
+        struct State
+        {
+            SDL_GPUTextureFormat format = SDL_GPU_TEXTUREFORMAT_INVALID;
+            ivec2 size;
+
+            // Those point into the loaded blob.
+            std::vector<blob> levels;
+        };
+        State state;
+
+      public:
+        CompressedImage() {}
+
+        // Parses the data. Throws on failure. `name` is only used in the error messages.
+        CompressedImage(std::string_view name, const blob_or_file &data);
+
+        CompressedImage(CompressedImage &&other) noexcept
+            : state(std::move(other.state))
+        {
+            other.state = {};
+        }
+        CompressedImage &operator=(CompressedImage other) noexcept
+        {
+            std::swap(state, other.state);
+            return *this;
+        }
+
+        // Returns true if the data starts with our header. Use this to tell those apart from the regular images.
+        [[nodiscard]] static bool Matches(const_byte_view data);
+
+        [[nodiscard]] explicit operator bool() const {return !state.levels.empty();}
+
+        [[nodiscard]] SDL_GPUTextureFormat GetFormat() const {return state.format;}
+        [[nodiscard]] ivec2 GetSize() const {return state.size;}
+
+        [[nodiscard]] int NumLevels() const {return int(state.levels.size());}
+        // The block data of a mipmap level.
+        [[nodiscard]] const blob &GetLevel(int level) const {return state.levels.at(std::size_t(level));}
+
+        // Returns true if the device supports this format with this usage.
+        [[nodiscard]] bool IsSupported(Device &device, Texture::UsageFlags usage = Texture::UsageFlags::sampler) const;
+
+        // Creates a texture with all the mipmap levels, and queues their uploads into `uploader`. Throws if the format isn't supported.
+        // The texture must not be used until `uploader.Flush()`.
+        [[nodiscard]] Texture CreateTexture(Device &device, StagingUploader &uploader, Texture::UsageFlags usage = Texture::UsageFlags::sampler) const;
+
+
+        // The formats that `Encode()` can produce. The container can hold any format (e.g. BC7 or ASTC), but those need external encoders.
+        enum class EncodeFormat
+        {
+            bc1, // Opaque RGB, 8 bytes per 4x4 block. 8 times smaller than RGBA8. `Encode()` rejects the images with transparent pixels.
+            bc3, // RGBA, 16 bytes per 4x4 block. 4 times smaller than RGBA8.
+        };
+
+        struct EncodeParams
+        {
+            EncodeFormat format = EncodeFormat::bc3;
+
+            // Generate the full mipmap chain with a box filter.
+            bool generate_mipmaps = true;
+
+            // Slower, but better quality.
+            bool high_quality = true;
+        };
+
+        // Compresses an image on the CPU. This is slow-ish, so do it offline.
+        // Throws if the image size isn't a multiple of 4, pad or resize it beforehand.
+        [[nodiscard]] static std::vector<unsigned char> Encode(const Image &image, const EncodeParams &params);
+    };
+}
@@ -0,0 +1,115 @@
+#include "compute_pass.h"
+
+#include "gpu/buffer.h"
+#include "gpu/command_buffer.h"
+#include "gpu/compute_pipeline.h"
+#include "gpu/sampler.h"
+#include "gpu/texture.h"
+
+#include <fmt/format.h>
+#include <SDL3/SDL_gpu.h>
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace em::Gpu
+{
+    ComputePass::ComputePass(CommandBuffer &command_buffer, const Params &params)
+        : ComputePass() // Ensure cleanup on throw.
+    {
+        std::vector<SDL_GPUStorageTextureReadWriteBinding> sdl_textures;
+        sdl_textures.reserve(params.storage_textures.size());
+        for (const StorageTexture &texture : params.storage_textures)
+        {
+            sdl_textures.push_back({
+                .texture = texture.texture->Handle(),
+                .mip_level = texture.mipmap_level,
+                .layer = texture.layer,
+                .cycle = texture.cycle,
+            });
+        }
+
+        std::vector<SDL_GPUStorageBufferReadWriteBinding> sdl_buffers;
+        sdl_buffers.reserve(params.storage_buffers.size());
+        for (const StorageBuffer &buffer : params.storage_buffers)
+        {
+            sdl_buffers.push_back({
+                .buffer = buffer.buffer->Handle(),
+                .cycle = buffer.cycle,
+            });
+        }
+
+        state.pass = SDL_BeginGPUComputePass(command_buffer.Handle(), sdl_textures.data(), std::uint32_t(sdl_textures.size()), sdl_buffers.data(), std::uint32_t(sdl_buffers.size()));
+        if (!state.pass)
+            throw std::runtime_error(fmt::format("Unable to begin a GPU compute pass: {}", SDL_GetError()));
+    }
+
+    ComputePass::ComputePass(ComputePass &&other) noexcept
+        : state(std::move(other.state))
+    {
+        other.state = {};
+    }
+
+    ComputePass &ComputePass::operator=(ComputePass other) noexcept
+    {
+        std::swap(state, other.state);
+        return *this;
+    }
+
+    ComputePass::~ComputePass()
+    {
+        if (state.pass)
+            SDL_EndGPUComputePass(state.pass);
+    }
+
+    void ComputePass::BindPipeline(ComputePipeline &pipeline)
+    {
+        // This can't fail.
+        SDL_BindGPUComputePipeline(state.pass, pipeline.Handle());
+    }
+
+    void ComputePass::BindSamplers(std::span<const Shader::TextureAndSampler> textures, std::uint32_t first_slot)
+    {
+        std::vector<SDL_GPUTextureSamplerBinding> sdl_textures;
+        sdl_textures.reserve(textures.size());
+        for (const Shader::TextureAndSampler &texture : textures)
+        {
+            sdl_textures.push_back({
+                .texture = texture.texture->Handle(),
+                .sampler = texture.sampler->Handle(),
+            });
+        }
+
+        // This can't fail.
+        SDL_BindGPUComputeSamplers(state.pass, first_slot, sdl_textures.data(), std::uint32_t(sdl_textures.size()));
+    }
+
+    void ComputePass::BindStorageTextures(std::span<Texture *const> textures, std::uint32_t first_slot)
+    {
+        std::vector<SDL_GPUTexture *> sdl_textures;
+        sdl_textures.reserve(textures.size());
+        for (Texture *texture : textures)
+            sdl_textures.push_back(texture->Handle());
+
+        // This can't fail.
+        SDL_BindGPUComputeStorageTextures(state.pass, first_slot, sdl_textures.data(), std::uint32_t(sdl_textures.size()));
+    }
+
+    void ComputePass::BindStorageBuffers(std::span<Buffer *const> buffers, std::uint32_t first_slot)
+    {
+        std::vector<SDL_GPUBuffer *> sdl_buffers;
+        sdl_buffers.reserve(buffers.size());
+        for (Buffer *buffer : buffers)
+            sdl_buffers.push_back(buffer->Handle());
+
+        // This can't fail.
+        SDL_BindGPUComputeStorageBuffers(state.pass, first_slot, sdl_buffers.data(), std::uint32_t(sdl_buffers.size()));
+    }
+
+    void ComputePass::Dispatch(uvec3 num_groups)
+    {
+        // This can't fail.
+        SDL_DispatchGPUCompute(state.pass, num_groups.x, num_groups.y, num_groups.z);
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "em/math/vector.h"
+#include "gpu/shader.h"
+
+#include <cstdint>
+#include <span>
+
+typedef struct SDL_GPUComputePass SDL_GPUComputePass;
+
+namespace em::Gpu
+{
+    class Buffer;
+    class CommandBuffer;
+    class ComputePipeline;
+    class Texture;
+
+    // Runs compute shaders, see `ComputePipeline`.
+    // The resources that the shaders write to must be specified when starting the pass. The read-only ones are bound later, like in `RenderPass`.
+    class ComputePass
+    {
+        struct State
+        {
+            SDL_GPUComputePass *pass = nullptr;
+        };
+        State state;
+
+      public:
+        constexpr ComputePass() {}
+
+        struct StorageTexture
+        {
+            // Must be created with `Texture::UsageFlags::compute_storage_write` (or `compute_storage_simultaneous_read_write`).
+            Texture *texture = nullptr;
+
+            std::uint32_t mipmap_level = 0;
+            std::uint32_t layer = 0;
+
+            // If true, discards the old contents if the texture is still in use. See `README-cycling.md`.
+            // False by default, since compute shaders often read the old contents.
+            bool cycle = false;
+        };
+
+        struct StorageBuffer
+        {
+            // Must be created with `Buffer::Usage::compute_storage_write`.
+            Buffer *buffer = nullptr;
+
+            // Same as in `StorageTexture`.
+            bool cycle = false;
+        };
+
+        struct Params
+        {
+            // Those are the read-write resources, bound to `set = 1` in the shader, in this order.
+            std::span<const StorageTexture> storage_textures;
+            std::span<const StorageBuffer> storage_buffers;
+        };
+
+        ComputePass(CommandBuffer &command_buffer, const Params &params);
+
+        ComputePass(ComputePass &&other) noexcept;
+        ComputePass &operator=(ComputePass other) noexcept;
+        ~ComputePass();
+
+        [[nodiscard]] explicit operator bool() const {return bool(state.pass);}
+        [[nodiscard]] SDL_GPUComputePass *Handle() {return state.pass;}
+
+        // Select the active pipeline.
+        void BindPipeline(ComputePipeline &pipeline);
+
+        // Those bind the read-only resources. See the comment on `ComputePipeline` for the slot numbering.
+        // The uniforms are set with `Shader::SetUniform(..., Shader::Stage::compute, ...)`.
+        void BindSamplers(std::span<const Shader::TextureAndSampler> textures, std::uint32_t first_slot = 0);
+        void BindStorageTextures(std::span<Texture *const> textures, std::uint32_t first_slot = 0);
+        void BindStorageBuffers(std::span<Buffer *const> buffers, std::uint32_t first_slot = 0);
+
+        // Runs the shader on this many workgroups. Use `ComputePipeline::NumGroupsFor()` to compute this from the number of threads.
+        void Dispatch(uvec3 num_groups);
+    };
+}
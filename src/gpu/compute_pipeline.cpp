@@ -0,0 +1,80 @@
+#include "compute_pipeline.h"
+
+#include "em/macros/utils/finally.h"
+#include "gpu/device.h"
+#include "sdl/properties.h"
+
+#include <fmt/format.h>
+#include <SDL3_shadercross/SDL_shadercross.h>
+#include <SDL3/SDL_gpu.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <utility>
+
+namespace em::Gpu
+{
+    ComputePipeline::ComputePipeline(Device &device, zstring_view name, const_byte_view spirv_binary)
+        : ComputePipeline() // Ensure cleanup on throw.
+    {
+        SdlProperties props;
+        props.Set(SDL_SHADERCROSS_PROP_SHADER_DEBUG_ENABLE_BOOLEAN, device.DebugModeEnabled());
+        props.Set(SDL_SHADERCROSS_PROP_SHADER_DEBUG_NAME_STRING, name);
+
+        SDL_ShaderCross_SPIRV_Info input{
+            .bytecode = reinterpret_cast<const unsigned char *>(spirv_binary.data()),
+            .bytecode_size = spirv_binary.size(),
+            .entrypoint = "main", // See the comment in `Shader::Shader()`.
+            .shader_stage = SDL_SHADERCROSS_SHADERSTAGE_COMPUTE,
+            .props = props.Handle(),
+        };
+
+        // Get the binding counts and the workgroup size.
+        SDL_ShaderCross_ComputePipelineMetadata *reflected_metadata = SDL_ShaderCross_ReflectComputeSPIRV(input.bytecode, input.bytecode_size, 0);
+        if (!reflected_metadata)
+            throw std::runtime_error(fmt::format("Unable to reflect SPIRV compute shader: {}", SDL_GetError()));
+        EM_FINALLY{ SDL_free(reflected_metadata); };
+
+        // Must set before creating the pipeline to let the destructor do its job if we throw later in this function.
+        state.device = device.Handle();
+
+        state.pipeline = SDL_ShaderCross_CompileComputePipelineFromSPIRV(device.Handle(), &input, reflected_metadata, 0);
+        if (!state.pipeline)
+            throw std::runtime_error(fmt::format("Unable to create a GPU compute pipeline: {}", SDL_GetError()));
+
+        state.threadcount = uvec3(reflected_metadata->threadcount_x, reflected_metadata->threadcount_y, reflected_metadata->threadcount_z);
+
+        static std::atomic<std::uint64_t> next_id = 1;
+        state.id = next_id++;
+    }
+
+    ComputePipeline::ComputePipeline(ComputePipeline &&other) noexcept
+        : state(std::move(other.state))
+    {
+        other.state = {};
+    }
+
+    ComputePipeline &ComputePipeline::operator=(ComputePipeline other) noexcept
+    {
+        std::swap(state, other.state);
+        return *this;
+    }
+
+    ComputePipeline::~ComputePipeline()
+    {
+        if (state.pipeline)
+            SDL_ReleaseGPUComputePipeline(state.device, state.pipeline);
+    }
+
+    uvec3 ComputePipeline::NumGroupsFor(uvec3 num_threads) const
+    {
+        if (!*this)
+            throw std::logic_error("Attempt to use a null `Gpu::ComputePipeline`.");
+
+        return uvec3(
+            (num_threads.x + state.threadcount.x - 1) / state.threadcount.x,
+            (num_threads.y + state.threadcount.y - 1) / state.threadcount.y,
+            (num_threads.z + state.threadcount.z - 1) / state.threadcount.z
+        );
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "em/math/vector.h"
+#include "em/zstring_view.h"
+#include "utils/byte_view.h"
+
+#include <cstdint>
+
+typedef struct SDL_GPUDevice SDL_GPUDevice;
+typedef struct SDL_GPUComputePipeline SDL_GPUComputePipeline;
+
+namespace em::Gpu
+{
+    class Device;
+
+    // A compute shader. Unlike the graphics shaders, SDL doesn't have a separate object for the compute shader itself, the pipeline is created directly from the shader code.
+    // Everything the pipeline needs (the number of bindings of each kind, the workgroup size) is obtained from the shader by reflection.
+    // Use this with `ComputePass`.
+    //
+    // In the shader use (see https://wiki.libsdl.org/SDL3/SDL_CreateGPUComputePipeline):
+    //   `layout(set = 0, binding = N)` for the sampled textures, then the read-only storage textures, then the read-only storage buffers.
+    //   `layout(set = 1, binding = N)` for the read-write storage textures, then the read-write storage buffers.
+    //   `layout(set = 2, binding = N)` for the uniform buffers.
+    class ComputePipeline
+    {
+        struct State
+        {
+            // This can't be `Device *` to keep the address stable.
+            SDL_GPUDevice *device = nullptr;
+            SDL_GPUComputePipeline *pipeline = nullptr;
+
+            // The workgroup size, from `layout(local_size_x = ..., ...) in;`.
+            uvec3 threadcount;
+
+            // See `UniqueId()`.
+            std::uint64_t id = 0;
+        };
+        State state;
+
+      public:
+        constexpr ComputePipeline() {}
+
+        // The name is optional.
+        ComputePipeline(Device &device, zstring_view name, const_byte_view spirv_binary);
+
+        ComputePipeline(ComputePipeline &&other) noexcept;
+        ComputePipeline &operator=(ComputePipeline other) noexcept;
+        ~ComputePipeline();
+
+        [[nodiscard]] explicit operator bool() const {return bool(state.pipeline);}
+        [[nodiscard]] SDL_GPUComputePipeline *Handle() {return state.pipeline;}
+
+        // A number that's different for every pipeline ever created by this process, or 0 for null pipelines. Like `Shader::UniqueId()`.
+        [[nodiscard]] std::uint64_t UniqueId() const {return state.id;}
+
+        // The workgroup size declared in the shader.
+        [[nodiscard]] uvec3 GetThreadCount() const {return state.threadcount;}
+
+        // How many workgroups are needed to cover `num_threads` threads, rounding up.
+        [[nodiscard]] uvec3 NumGroupsFor(uvec3 num_threads) const;
+    };
+}
@@ -1,6 +1,7 @@
 #include "device.h"
 
 #include "em/macros/meta/if_else.h"
+#include "gpu/pipeline_cache.h"
 #ifdef _WIN32
 #include "em/macros/utils/finally.h"
 #endif
@@ -61,6 +62,8 @@ namespace em::Gpu
             if (!state.device)
                 throw std::runtime_error(fmt::format("Unable to initialize the GPU device: {}", initial_error));
         }
+
+        state.pipeline_cache = std::make_shared<PipelineCache>();
     }
 
     Device::Device(Device &&other) noexcept
@@ -77,7 +80,17 @@ namespace em::Gpu
 
     Device::~Device()
     {
+        // Release the cached pipelines while the device still exists.
+        state.pipeline_cache = nullptr;
+
         if (state.device)
             SDL_DestroyGPUDevice(state.device);
     }
+
+    PipelineCache &Device::GetPipelineCache()
+    {
+        if (!state.pipeline_cache)
+            throw std::logic_error("Attempt to use the pipeline cache of a null `Gpu::Device`.");
+        return *state.pipeline_cache;
+    }
 }
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <memory>
 
 typedef struct SDL_GPUDevice SDL_GPUDevice;
 
 namespace em::Gpu
 {
+    class PipelineCache;
+
     // This is attached to a window to render to it, or can be used for headless rendering. Presumably it can handle multiple windows at the same time.
     // In theory SDL lets you create this before or after the window, I believe? But our API requires this to be created first and then passed to the window,
     //   which makes sense, because multiple windows can share one GPU device.
@@ -14,6 +17,9 @@ namespace em::Gpu
         {
             SDL_GPUDevice *device = nullptr;
             bool debug_mode_enabled = false;
+
+            // This is a `shared_ptr` only to allow the incomplete type here.
+            std::shared_ptr<PipelineCache> pipeline_cache;
         };
         State state;
 
@@ -36,5 +42,8 @@ namespace em::Gpu
         [[nodiscard]] SDL_GPUDevice *Handle() {return state.device;}
 
         [[nodiscard]] bool DebugModeEnabled() const {return state.debug_mode_enabled;}
+
+        // The pipelines shared by everything using this device. Throws if this is a null instance.
+        [[nodiscard]] PipelineCache &GetPipelineCache();
     };
 }
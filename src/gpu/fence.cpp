@@ -3,11 +3,71 @@
 #include <fmt/format.h>
 #include <SDL3/SDL_gpu.h>
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <stdexcept>
 #include <utility>
 
 namespace em::Gpu
 {
+    namespace
+    {
+        // Calls `func(Fence &)` for every non-null fence.
+        template <typename F>
+        void ForEachNonNullFence(std::span<Fence *const> fences, F &&func)
+        {
+            for (Fence *fence : fences)
+            {
+                if (fence && *fence)
+                    func(*fence);
+            }
+        }
+
+        [[nodiscard]] std::vector<Fence *> FencePointers(std::span<Fence> fences)
+        {
+            std::vector<Fence *> ret;
+            ret.reserve(fences.size());
+            for (Fence &fence : fences)
+                ret.push_back(&fence);
+            return ret;
+        }
+
+        // Returns false if there are no non-null fences.
+        bool WaitForFences(std::span<Fence *const> fences, bool wait_all)
+        {
+            // This is called every frame, so avoid allocating for the common case of a few fences.
+            constexpr std::size_t max_stack_handles = 16;
+            std::array<SDL_GPUFence *, max_stack_handles> stack_handles;
+            std::vector<SDL_GPUFence *> heap_handles;
+            if (fences.size() > max_stack_handles)
+                heap_handles.resize(fences.size());
+            SDL_GPUFence **handles = heap_handles.empty() ? stack_handles.data() : heap_handles.data();
+
+            SDL_GPUDevice *device = nullptr;
+            std::size_t num_handles = 0;
+
+            ForEachNonNullFence(fences, [&](Fence &fence)
+            {
+                SDL_GPUDevice *this_device = fence.DeviceHandle();
+                if (!device)
+                    device = this_device;
+                else if (device != this_device)
+                    throw std::logic_error("Attempt to wait for GPU fences from different devices at once.");
+
+                handles[num_handles++] = fence.Handle();
+            });
+
+            if (num_handles == 0)
+                return false;
+
+            if (!SDL_WaitForGPUFences(device, wait_all, handles, std::uint32_t(num_handles)))
+                throw std::runtime_error(fmt::format("Unable to wait for {} GPU fences: {}", wait_all ? "all" : "any of the", SDL_GetError()));
+
+            return true;
+        }
+    }
+
     Fence::Fence(TakeOwnershipOfExistingFence, SDL_GPUDevice *device, SDL_GPUFence *fence)
         : Fence() // Ensure cleanup on throw.
     {
@@ -43,4 +103,107 @@ namespace em::Gpu
         if (!SDL_WaitForGPUFences(state.device, false, &state.fence, 1))
             throw std::runtime_error(fmt::format("Unable to wait for a GPU fence: {}", SDL_GetError()));
     }
+
+    void Fence::WaitAll(std::span<Fence *const> fences)
+    {
+        (void)WaitForFences(fences, true);
+    }
+
+    void Fence::WaitAll(std::span<Fence> fences)
+    {
+        WaitAll(FencePointers(fences));
+    }
+
+    std::size_t Fence::WaitAny(std::span<Fence *const> fences)
+    {
+        if (fences.empty())
+            throw std::logic_error("Attempt to wait for any GPU fence in an empty list.");
+
+        if (!WaitForFences(fences, false))
+            return 0; // All fences are null, so the first one is "ready".
+
+        // SDL doesn't tell us which fence is ready, so we have to check them.
+        for (std::size_t i = 0; i < fences.size(); i++)
+        {
+            if (fences[i] && *fences[i] && fences[i]->IsReady())
+                return i;
+        }
+
+        throw std::runtime_error("Waited for any GPU fence, but none of them are ready.");
+    }
+
+    std::size_t Fence::WaitAny(std::span<Fence> fences)
+    {
+        return WaitAny(FencePointers(fences));
+    }
+
+
+    void FencePool::Recycle(std::size_t in_flight_index)
+    {
+        std::unique_ptr<Fence> fence = std::move(state.in_flight[in_flight_index]);
+        state.in_flight.erase(state.in_flight.begin() + std::ptrdiff_t(in_flight_index));
+
+        *fence = {}; // Release the SDL fence.
+        state.free.push_back(std::move(fence));
+    }
+
+    Fence &FencePool::Acquire()
+    {
+        if (state.free.empty())
+            state.free.push_back(std::make_unique<Fence>());
+
+        state.in_flight.push_back(std::move(state.free.back()));
+        state.free.pop_back();
+        return *state.in_flight.back();
+    }
+
+    void FencePool::RecycleReady()
+    {
+        // Backwards to keep the indices valid while erasing.
+        for (std::size_t i = state.in_flight.size(); i-- > 0;)
+        {
+            // The null fences weren't submitted yet, and their command buffers still point to them, so they must stay in flight.
+            Fence &fence = *state.in_flight[i];
+            if (fence && fence.IsReady())
+                Recycle(i);
+        }
+    }
+
+    void FencePool::Discard(Fence &fence)
+    {
+        auto iter = std::find_if(state.in_flight.begin(), state.in_flight.end(), [&](const std::unique_ptr<Fence> &ptr){return ptr.get() == &fence;});
+        if (iter == state.in_flight.end())
+            throw std::logic_error("Attempt to discard a fence that doesn't belong to this `Gpu::FencePool`.");
+        Recycle(std::size_t(iter - state.in_flight.begin()));
+    }
+
+    void FencePool::WaitAll()
+    {
+        state.scratch.clear();
+        for (const auto &fence : state.in_flight)
+            state.scratch.push_back(fence.get());
+
+        Fence::WaitAll(state.scratch);
+
+        // Everything non-null is ready now. The null fences weren't submitted yet, so they stay in flight, see `RecycleReady()`.
+        for (std::size_t i = state.in_flight.size(); i-- > 0;)
+        {
+            if (*state.in_flight[i])
+                Recycle(i);
+        }
+    }
+
+    void FencePool::WaitAny()
+    {
+        if (state.in_flight.empty())
+            return;
+
+        state.scratch.clear();
+        for (const auto &fence : state.in_flight)
+            state.scratch.push_back(fence.get());
+
+        (void)Fence::WaitAny(state.scratch);
+
+        RecycleReady();
+    }
 }
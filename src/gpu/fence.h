@@ -1,5 +1,10 @@
 #pragma once
 
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
 typedef struct SDL_GPUDevice SDL_GPUDevice;
 typedef struct SDL_GPUFence SDL_GPUFence;
 
@@ -29,12 +34,77 @@ namespace em::Gpu
 
         [[nodiscard]] explicit operator bool() const {return bool(state.fence);}
         [[nodiscard]] SDL_GPUFence *Handle() {return state.fence;}
+        [[nodiscard]] SDL_GPUDevice *DeviceHandle() {return state.device;}
 
         // Doesn't block, returns true if the fence is ready.
         [[nodiscard]] bool IsReady();
 
         // Blocks until the fence is ready. Throws on failure.
-        // SDL also provides a way to wait for more than once fence (any or all of them), but we don't expose that yet.
         void Wait();
+
+        // Those wait for several fences with a single call.
+        // Null fences (and null pointers) are skipped, as if they were already ready. All the other fences must belong to the same device.
+        // Blocks until all fences are ready. Throws on failure.
+        static void WaitAll(std::span<Fence *const> fences);
+        static void WaitAll(std::span<Fence> fences);
+        // Blocks until at least one fence is ready, and returns its index. Throws on failure.
+        // If there are no non-null fences, returns immediately with the index of the first null one, or throws if the span is empty.
+        static std::size_t WaitAny(std::span<Fence *const> fences);
+        static std::size_t WaitAny(std::span<Fence> fences);
+    };
+
+    // Recycles `Fence` objects, to avoid allocating new ones for every submitted command buffer.
+    // Pass `&pool.Acquire()` to `CommandBuffer` as the `output_fence`, then use `WaitAll()`/`WaitAny()` to wait for all the fences in flight.
+    // The fences are recycled by `RecycleReady()` (and the waiting functions), which releases the underlying SDL fences that have finished.
+    // The fences that weren't submitted yet (that are still null) are never recycled, since a `CommandBuffer` may still fill them.
+    //   If you cancel a command buffer, pass its fence to `Discard()`.
+    class FencePool
+    {
+        struct State
+        {
+            // The fences are stored by pointer, because `CommandBuffer` needs them to stay in place until it's submitted.
+            // Those are the fences that were acquired and not recycled yet.
+            std::vector<std::unique_ptr<Fence>> in_flight;
+            // Those are null.
+            std::vector<std::unique_ptr<Fence>> free;
+
+            // Reused by the waiting functions to avoid allocations.
+            std::vector<Fence *> scratch;
+        };
+        State state;
+
+        void Recycle(std::size_t in_flight_index);
+
+      public:
+        FencePool() {}
+
+        FencePool(FencePool &&other) noexcept
+            : state(std::move(other.state))
+        {
+            other.state = {};
+        }
+        FencePool &operator=(FencePool other) noexcept
+        {
+            std::swap(state, other.state);
+            return *this;
+        }
+
+        // Returns a null fence that you should pass to `CommandBuffer` to be filled on submit.
+        // It stays at the same address until it gets recycled after becoming ready.
+        [[nodiscard]] Fence &Acquire();
+
+        // How many fences were acquired and not recycled yet.
+        [[nodiscard]] std::size_t NumInFlight() const {return state.in_flight.size();}
+
+        // Doesn't block. Recycles the fences that were submitted and are ready.
+        void RecycleReady();
+
+        // Returns a fence from `Acquire()` that won't be submitted, e.g. because its command buffer was cancelled. Throws if it's not from this pool.
+        void Discard(Fence &fence);
+
+        // Blocks until all fences in flight are ready, then recycles them.
+        void WaitAll();
+        // Blocks until at least one fence in flight is ready (if there are any), then recycles the ready ones.
+        void WaitAny();
     };
 }
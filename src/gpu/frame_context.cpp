@@ -0,0 +1,157 @@
+#include "frame_context.h"
+
+#include "command_line/parser.h"
+#include "gpu/device.h"
+
+#include <fmt/format.h>
+#include <SDL3/SDL_gpu.h>
+
+#include <stdexcept>
+#include <string>
+
+namespace em::Gpu
+{
+    FrameContext::Frame &FrameContext::NextSlot()
+    {
+        if (!*this)
+            throw std::logic_error("Attempt to use a null `Gpu::FrameContext`.");
+
+        state.cur_slot = (state.cur_slot + 1) % state.frames.size();
+        state.frame_counter++;
+
+        Frame &frame = *state.frames[state.cur_slot];
+
+        if (frame.fence)
+        {
+            frame.fence.Wait();
+            frame.fence = {};
+        }
+
+        // Everything from the older frames is already done at this point, since their slots were waited for before this one.
+        frame.deferred_destruction.clear();
+
+        return frame;
+    }
+
+    FrameContext::FrameContext(Device &device, FramePacing pacing)
+    {
+        state.device = device.Handle();
+        SetPacing(pacing);
+    }
+
+    void FrameContext::SetPacing(FramePacing new_pacing)
+    {
+        if (!state.device)
+            throw std::logic_error("Attempt to use a null `Gpu::FrameContext`.");
+
+        WaitIdle();
+
+        std::size_t num_frames = NumFramesInFlightForPacing(new_pacing);
+        if (!SDL_SetGPUAllowedFramesInFlight(state.device, std::uint32_t(num_frames)))
+            throw std::runtime_error(fmt::format("Unable to set the number of GPU frames in flight to {}: {}", num_frames, SDL_GetError()));
+
+        state.pacing = new_pacing;
+
+        state.frames.resize(num_frames);
+        for (auto &frame : state.frames)
+        {
+            if (!frame)
+                frame = std::make_unique<Frame>();
+        }
+
+        // So that the next frame uses slot 0.
+        state.cur_slot = state.frames.size() - 1;
+    }
+
+    std::size_t FrameContext::NumFramesInFlightForPacing(FramePacing pacing)
+    {
+        switch (pacing)
+        {
+          case FramePacing::latency:
+            return 1;
+          case FramePacing::balanced:
+          case FramePacing::cpu_work_while_waiting:
+            return 2;
+          case FramePacing::throughput:
+            return 3;
+        }
+        throw std::logic_error("Invalid `Gpu::FramePacing` enum.");
+    }
+
+    SwapchainAcquireResult FrameContext::BeginFrame(Window &window, Device &device)
+    {
+        if (state.pacing == FramePacing::cpu_work_while_waiting)
+        {
+            if (!*this)
+                throw std::logic_error("Attempt to use a null `Gpu::FrameContext`.");
+
+            // Don't block on our own fence either.
+            Fence &next_fence = state.frames[(state.cur_slot + 1) % state.frames.size()]->fence;
+            if (next_fence && !next_fence.IsReady())
+                return {.would_block = true};
+
+            // Only advance to the next slot if we got the texture, otherwise every failed attempt would burn a slot and a frame counter tick.
+            // It's fine to give the command buffer this fence before `NextSlot()` resets it, since it's only written on submit.
+            SwapchainAcquireResult ret = TryAcquireSwapchainTextureAndCmdBuf(window, device, &next_fence);
+            if (ret)
+                (void)NextSlot();
+            return ret;
+        }
+
+        Frame &frame = NextSlot();
+        return WaitAndAcquireSwapchainTextureAndCmdBuf(window, device, &frame.fence);
+    }
+
+    CommandBuffer FrameContext::BeginFrame(Device &device)
+    {
+        Frame &frame = NextSlot();
+        return CommandBuffer(device, &frame.fence);
+    }
+
+    std::size_t FrameContext::NumDeferredObjects() const
+    {
+        std::size_t ret = 0;
+        for (const auto &frame : state.frames)
+            ret += frame->deferred_destruction.size();
+        return ret;
+    }
+
+    void FrameContext::WaitIdle()
+    {
+        std::vector<Fence *> fences;
+        fences.reserve(state.frames.size());
+        for (const auto &frame : state.frames)
+            fences.push_back(&frame->fence);
+
+        Fence::WaitAll(fences);
+
+        for (const auto &frame : state.frames)
+        {
+            frame->fence = {};
+            frame->deferred_destruction.clear();
+        }
+    }
+
+    void FrameContext::ProvidedCommandLineFlags(CommandLine::Parser &parser)
+    {
+        parser.AddFlag<std::string>(
+            "--frame-pacing",
+            {},
+            "mode",
+            "How many frames can be in flight: `latency` (one), `balanced` (two, the default), `throughput` (three), or `cpu-work` (two, but do CPU work instead of waiting for the GPU).",
+            [this](const std::string &mode)
+            {
+                if (mode == "latency")
+                    SetPacing(FramePacing::latency);
+                else if (mode == "balanced")
+                    SetPacing(FramePacing::balanced);
+                else if (mode == "throughput")
+                    SetPacing(FramePacing::throughput);
+                else if (mode == "cpu-work")
+                    SetPacing(FramePacing::cpu_work_while_waiting);
+                else
+                    throw std::runtime_error(fmt::format("Unknown frame pacing mode `{}`, expected `latency`, `balanced`, `throughput` or `cpu-work`.", mode));
+            }
+        );
+    }
+}
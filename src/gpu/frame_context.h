@@ -0,0 +1,178 @@
+#pragma once
+
+#include "gpu/command_buffer.h"
+#include "gpu/fence.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+typedef struct SDL_GPUDevice SDL_GPUDevice;
+
+namespace em
+{
+    class Window;
+}
+
+namespace em::CommandLine
+{
+    class Parser;
+}
+
+namespace em::Gpu
+{
+    class Device;
+
+    // How `FrameContext` balances input latency against GPU utilization.
+    enum class FramePacing
+    {
+        // One frame in flight. The CPU waits for the GPU to finish the previous frame before starting the next one. The lowest latency.
+        latency,
+        // Two frames in flight, the SDL default.
+        balanced,
+        // Three frames in flight. Keeps the GPU busy if the frame times are uneven, at the cost of latency.
+        throughput,
+        // Two frames in flight, but `FrameContext::BeginFrame()` never blocks. Instead it returns `.would_block == true`,
+        //   and you can do CPU work (e.g. simulation) and try again on the next tick, instead of sleeping inside SDL.
+        cpu_work_while_waiting,
+    };
+
+    // Tracks the frames in flight, using the fences of their command buffers.
+    // Use `BeginFrame()` instead of `WaitAndAcquireSwapchainTextureAndCmdBuf()`. Before reusing a frame slot, it waits for the frame that last used it,
+    //   so anything that belongs to the current slot (see `PerFrame`) is no longer used by the GPU, and can be overwritten without cycling.
+    //
+    // The number of frames in flight depends on the `FramePacing`, which also configures SDL via `SDL_SetGPUAllowedFramesInFlight()`.
+    //
+    // It also lets you destroy resources with a delay, with `DeferDestruction()`. SDL already destroys the resources lazily, but this makes the
+    //   moment of destruction deterministic, and lets you see how much is pending.
+    class FrameContext
+    {
+        struct Frame
+        {
+            // Filled when the frame's command buffer gets submitted. Null if the frame was skipped or cancelled.
+            // Must stay at the same address while the command buffer exists, so the frames are stored by pointer.
+            Fence fence;
+
+            // Destroyed when this slot is reused.
+            std::vector<std::shared_ptr<void>> deferred_destruction;
+        };
+
+        struct State
+        {
+            // Not a `Device *` to keep the address stable.
+            SDL_GPUDevice *device = nullptr;
+
+            FramePacing pacing{};
+
+            std::vector<std::unique_ptr<Frame>> frames;
+
+            // Which slot the current frame uses. Before the first `BeginFrame()` this is the last slot.
+            std::size_t cur_slot = 0;
+
+            // How many times `BeginFrame()` was called.
+            std::uint64_t frame_counter = 0;
+        };
+        State state;
+
+        // Advances to the next slot, waits for its fence, and destroys its deferred objects.
+        [[nodiscard]] Frame &NextSlot();
+
+      public:
+        constexpr FrameContext() {}
+
+        // Throws if SDL rejects the pacing.
+        explicit FrameContext(Device &device, FramePacing pacing = FramePacing::balanced);
+
+        FrameContext(FrameContext &&other) noexcept
+            : state(std::move(other.state))
+        {
+            other.state = {};
+        }
+        FrameContext &operator=(FrameContext other) noexcept
+        {
+            std::swap(state, other.state);
+            return *this;
+        }
+
+        [[nodiscard]] explicit operator bool() const {return !state.frames.empty();}
+
+        [[nodiscard]] std::size_t NumFramesInFlight() const {return state.frames.size();}
+
+        [[nodiscard]] FramePacing GetPacing() const {return state.pacing;}
+        // Waits for all frames in flight (see `WaitIdle()`), then changes the number of them.
+        // This invalidates the `PerFrame` objects if the number of frames changes, so prefer doing this at startup.
+        void SetPacing(FramePacing new_pacing);
+
+        [[nodiscard]] static std::size_t NumFramesInFlightForPacing(FramePacing pacing);
+
+        // The slot of the current frame, in range `[0, NumFramesInFlight())`. Use this to index per-frame resources.
+        [[nodiscard]] std::size_t CurrentSlot() const {return state.cur_slot;}
+
+        // How many frames were started so far, including the current one.
+        [[nodiscard]] std::uint64_t FrameCounter() const {return state.frame_counter;}
+
+        // Advances to the next slot, waits until the GPU is done with the frame that last used it, then acquires the swapchain texture and the command buffer.
+        // The command buffer fills the fence of this slot when submitted. Like `WaitAndAcquireSwapchainTextureAndCmdBuf()`, this CAN RETURN NULL
+        //   if the window is minimized. Then skip the frame.
+        // With `FramePacing::cpu_work_while_waiting` this doesn't block, and returns null with `.would_block == true` if the GPU is still busy.
+        //   Then you can do some other work and call this again. The slot only advances when this succeeds.
+        //   Note that `.would_block` is a heuristic: SDL doesn't say why it didn't give us a texture, so we assume the GPU is busy unless the window is minimized.
+        //   E.g. a window that's hidden or occluded without being minimized may keep reporting `.would_block == true`.
+        [[nodiscard]] SwapchainAcquireResult BeginFrame(Window &window, Device &device);
+
+        // Same as `BeginFrame()`, but for headless rendering. Returns a command buffer that fills the fence of this slot.
+        [[nodiscard]] CommandBuffer BeginFrame(Device &device);
+
+        // Keeps `object` alive until the GPU is done with the current frame, then destroys it.
+        // Use this for the resources that are replaced mid-frame while the previous frames might still be using them (e.g. a buffer that was reallocated).
+        template <typename T>
+        void DeferDestruction(T &&object)
+        {
+            if (!*this)
+                throw std::logic_error("Attempt to use a null `Gpu::FrameContext`.");
+            state.frames[state.cur_slot]->deferred_destruction.push_back(std::make_shared<std::remove_cvref_t<T>>(std::forward<T>(object)));
+        }
+
+        // The number of objects waiting in `DeferDestruction()`.
+        [[nodiscard]] std::size_t NumDeferredObjects() const;
+
+        // Blocks until all frames in flight are done, and destroys all deferred objects.
+        void WaitIdle();
+
+        // Adds `--frame-pacing`.
+        void ProvidedCommandLineFlags(CommandLine::Parser &parser);
+    };
+
+    // Holds one `T` per frame in flight, and returns the one for the current frame.
+    // Use this for resources that are refilled every frame, e.g. transfer buffers (mapped with `cycle == false`) or `Graphics::StreamingBuffer`s (with cycling disabled).
+    template <typename T>
+    class PerFrame
+    {
+        std::vector<T> objects;
+
+      public:
+        PerFrame() {}
+
+        // Calls `make()` once per frame in flight.
+        template <typename F>
+        PerFrame(const FrameContext &context, F &&make)
+        {
+            objects.reserve(context.NumFramesInFlight());
+            for (std::size_t i = 0; i < context.NumFramesInFlight(); i++)
+                objects.push_back(make());
+        }
+
+        [[nodiscard]] explicit operator bool() const {return !objects.empty();}
+
+        [[nodiscard]] T &Current(const FrameContext &context) {return objects.at(context.CurrentSlot());}
+        [[nodiscard]] const T &Current(const FrameContext &context) const {return objects.at(context.CurrentSlot());}
+
+        [[nodiscard]] std::span<T> All() {return objects;}
+        [[nodiscard]] std::span<const T> All() const {return objects;}
+    };
+}
@@ -1,6 +1,7 @@
 #include "pipeline.h"
 
 #include "gpu/device.h"
+#include "gpu/pipeline_cache.h"
 #include "gpu/shader.h"
 
 #include <fmt/format.h>
@@ -214,13 +215,55 @@ namespace em::Gpu
             SDL_ReleaseGPUGraphicsPipeline(state.device, state.pipeline);
     }
 
-    void DynamicPipeline::RequestOutputFormat(Device &device, SDL_GPUTextureFormat format)
+    void DynamicPipeline::SelectVariant(Device &device, SDL_GPUTextureFormat format, AsyncCreator *creator)
     {
-        SDL_GPUTextureFormat &cur_format = params.targets.color.at(0).texture_format;
-        if (!*this || cur_format != format)
+        Pipeline::Shaders &shaders = state.params.shaders;
+        if (!shaders.vert || !shaders.frag)
+            throw std::logic_error("A `DynamicPipeline` must have both shaders set.");
+
+        // The old pipelines are useless if any of the shaders were replaced.
+        if (shaders.vert->UniqueId() != state.vert_id || shaders.frag->UniqueId() != state.frag_id)
         {
-            cur_format = format;
-            Pipeline::operator=(Pipeline(device, params));
+            state.variants.clear();
+            state.current.reset();
+            state.vert_id = shaders.vert->UniqueId();
+            state.frag_id = shaders.frag->UniqueId();
         }
+
+        for (std::size_t i = 0; i < state.variants.size(); i++)
+        {
+            if (state.variants[i].format == format)
+            {
+                state.current = i;
+                return;
+            }
+        }
+
+        state.params.targets.color.at(0).texture_format = format;
+
+        PipelineCache &cache = device.GetPipelineCache();
+        AsyncObject<Pipeline> pipeline = creator ? cache.GetAsync(*creator, device, state.params) : AsyncObject<Pipeline>(cache.Get(device, state.params));
+
+        state.variants.push_back({.format = format, .pipeline = std::move(pipeline)});
+        state.current = state.variants.size() - 1;
+    }
+
+    bool DynamicPipeline::IsReady() const
+    {
+        return state.current && state.variants[*state.current].pipeline.IsReady();
+    }
+
+    Pipeline &DynamicPipeline::GetPipeline()
+    {
+        if (!state.current)
+            throw std::logic_error("Must call `DynamicPipeline::RequestOutputFormat[Async]()` before using the pipeline.");
+        return *state.variants[*state.current].pipeline.Get();
+    }
+
+    Pipeline &DynamicPipeline::GetPipelineOr(Pipeline &fallback)
+    {
+        if (!state.current)
+            throw std::logic_error("Must call `DynamicPipeline::RequestOutputFormat[Async]()` before using the pipeline.");
+        return state.variants[*state.current].pipeline.GetOr(fallback);
     }
 }
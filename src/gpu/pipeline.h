@@ -1,16 +1,21 @@
 #pragma once
 
 #include "em/math/vector.h"
+#include "gpu/async_object.h"
 #include "gpu/multisample.h"
 
 #include <SDL3/SDL_gpu.h>
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <optional>
+#include <utility>
 #include <vector>
 
 namespace em::Gpu
 {
+    class AsyncCreator;
     class Device;
     class Shader;
 
@@ -316,15 +321,70 @@ namespace em::Gpu
     };
 
     // A wrapper for `Pipeline` that can be easily adapted for changing target texture formats, like of a swapchain texture.
-    class DynamicPipeline : public Pipeline
+    // This keeps one pipeline per requested format, so alternating between several targets doesn't recreate anything.
+    //   The pipelines come from `Device::GetPipelineCache()`, so they are also shared with other `DynamicPipeline`s that have the same parameters.
+    // This also switches to new pipelines when the shaders are replaced in place (e.g. by the shader hot reload in `Graphics::ShaderManager`).
+    class DynamicPipeline
     {
-        Pipeline::Params params;
+        struct Variant
+        {
+            SDL_GPUTextureFormat format{};
+            AsyncObject<Pipeline> pipeline;
+        };
+
+        struct State
+        {
+            Pipeline::Params params;
+
+            // The `Shader::UniqueId()`s of the shaders that `variants` were created with.
+            std::uint64_t vert_id = 0;
+            std::uint64_t frag_id = 0;
+
+            std::vector<Variant> variants;
+
+            // The index in `variants`. Null until the first `RequestOutputFormat[Async]()`.
+            std::optional<std::size_t> current;
+        };
+        State state;
+
+        void SelectVariant(Device &device, SDL_GPUTextureFormat format, AsyncCreator *creator);
 
       public:
         constexpr DynamicPipeline() {}
-        DynamicPipeline(Params params) : params(std::move(params)) {}
+        DynamicPipeline(Pipeline::Params params) {state.params = std::move(params);}
+
+        DynamicPipeline(DynamicPipeline &&other) noexcept
+            : state(std::move(other.state))
+        {
+            other.state = {};
+        }
+        DynamicPipeline &operator=(DynamicPipeline other) noexcept
+        {
+            std::swap(state, other.state);
+            return *this;
+        }
+
+        // Must call this (or `RequestOutputFormatAsync()`) to actually create the underlying pipeline. Call it before every use, since it's cheap when nothing changes.
+        // Switches to the pipeline for this format, creating it if needed. Drops all the pipelines if any of the shaders were replaced.
+        void RequestOutputFormat(Device &device, SDL_GPUTextureFormat format) {SelectVariant(device, format, nullptr);}
+
+        // Same, but if the pipeline needs to be created, creates it on the worker threads of `creator`. Then use `GetPipelineOr()` until it's ready.
+        void RequestOutputFormatAsync(Device &device, SDL_GPUTextureFormat format, AsyncCreator &creator) {SelectVariant(device, format, &creator);}
+
+        // Returns true after the first `RequestOutputFormat[Async]()`.
+        [[nodiscard]] explicit operator bool() const {return state.current.has_value();}
+
+        // Returns true if the pipeline for the last requested format is ready to be used without blocking.
+        [[nodiscard]] bool IsReady() const;
+
+        // The pipeline for the last requested format. Throws if `RequestOutputFormat[Async]()` wasn't called yet.
+        // If it's still being created asynchronously, blocks until it's ready.
+        [[nodiscard]] Pipeline &GetPipeline();
+
+        // Same, but returns `fallback` instead of blocking, if the pipeline isn't ready yet.
+        [[nodiscard]] Pipeline &GetPipelineOr(Pipeline &fallback);
 
-        // Must call this to actually create the underlying pipeline.
-        void RequestOutputFormat(Device &device, SDL_GPUTextureFormat format);
+        // To help passing this into `RenderPass::BindPipeline()`.
+        operator Pipeline &() {return GetPipeline();}
     };
 }
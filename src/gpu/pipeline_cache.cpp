@@ -0,0 +1,196 @@
+#include "pipeline_cache.h"
+
+#include "gpu/async_creator.h"
+#include "gpu/device.h"
+#include "gpu/shader.h"
+
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace em::Gpu
+{
+    std::string PipelineCache::MakeKey(const Pipeline::Params &params)
+    {
+        std::string ret;
+
+        auto Append = [&]<typename T>(const T &value)
+        {
+            static_assert(std::is_scalar_v<T>, "Only append scalars, since other types can have padding.");
+            ret.append(reinterpret_cast<const char *>(&value), sizeof(value));
+        };
+
+        auto AppendOptional = [&]<typename T>(const std::optional<T> &value, auto &&func)
+        {
+            Append(value.has_value());
+            if (value)
+                func(*value);
+        };
+
+        Append(params.shaders.vert ? params.shaders.vert->UniqueId() : 0);
+        Append(params.shaders.frag ? params.shaders.frag->UniqueId() : 0);
+
+        Append(params.vertex_buffers.size());
+        for (const Pipeline::VertexBuffer &buffer : params.vertex_buffers)
+        {
+            Append(buffer.pitch);
+            Append(buffer.per_instance);
+            Append(buffer.attributes.size());
+            for (const Pipeline::VertexAttribute &attribute : buffer.attributes)
+            {
+                AppendOptional(attribute.custom_location_in_shader, Append);
+                Append(attribute.format);
+                Append(attribute.byte_offset_in_elem);
+            }
+        }
+
+        auto AppendChannelBlending = [&](const Pipeline::ChannelBlending &blending)
+        {
+            Append(blending.source);
+            Append(blending.target);
+            Append(blending.operation);
+        };
+
+        Append(params.targets.color.size());
+        for (const Pipeline::ColorTarget &target : params.targets.color)
+        {
+            Append(target.texture_format);
+            AppendOptional(target.blending, [&](const Pipeline::Blending &blending)
+            {
+                AppendChannelBlending(blending.color);
+                AppendChannelBlending(blending.alpha);
+            });
+            Append(target.color_write_mask.x);
+            Append(target.color_write_mask.y);
+            Append(target.color_write_mask.z);
+            Append(target.color_write_mask.w);
+        }
+        AppendOptional(params.targets.depth_stencil_format, Append);
+
+        Append(params.primitive);
+
+        Append(params.rasterizer.wireframe);
+        Append(params.rasterizer.culling);
+        Append(params.rasterizer.front_faces_are_clockwise);
+        AppendOptional(params.rasterizer.depth_bias, [&](const Pipeline::DepthBias &bias)
+        {
+            Append(bias.constant_factor);
+            Append(bias.slope_factor);
+            Append(bias.clamp);
+        });
+        Append(params.rasterizer.clip_by_depth);
+
+        Append(params.multisample.samples);
+
+        AppendOptional(params.depth, [&](const Pipeline::Depth &depth)
+        {
+            Append(depth.depth_pass_condition);
+            Append(depth.write_depth);
+        });
+
+        auto AppendStencilOperation = [&](const Pipeline::StencilOperation &op)
+        {
+            Append(op.on_fail_stencil);
+            Append(op.on_pass_stencil_and_depth);
+            Append(op.on_pass_stencil_but_fail_depth);
+            Append(op.stencil_pass_condition);
+        };
+        AppendOptional(params.stencil, [&](const Pipeline::Stencil &stencil)
+        {
+            AppendStencilOperation(stencil.front_faces);
+            AppendStencilOperation(stencil.back_faces);
+            Append(stencil.compare_mask);
+            Append(stencil.write_mask);
+        });
+
+        return ret;
+    }
+
+    void PipelineCache::EvictOverflow()
+    {
+        while (state.entries.size() > state.max_pipelines)
+        {
+            state.entry_by_key.erase(state.entries.back().key);
+            state.entries.pop_back();
+            state.stats.evictions++;
+        }
+    }
+
+    PipelineCache::Entry *PipelineCache::FindEntry(const std::string &key)
+    {
+        auto iter = state.entry_by_key.find(key);
+        if (iter == state.entry_by_key.end())
+            return nullptr;
+
+        // Move to the front.
+        state.entries.splice(state.entries.begin(), state.entries, iter->second);
+        return &*iter->second;
+    }
+
+    void PipelineCache::AddEntry(std::string key, AsyncObject<Pipeline> pipeline)
+    {
+        if (state.max_pipelines == 0)
+            return;
+
+        state.entries.push_front({.key = key, .pipeline = std::move(pipeline)});
+        state.entry_by_key.try_emplace(std::move(key), state.entries.begin());
+        EvictOverflow();
+    }
+
+    std::shared_ptr<Pipeline> PipelineCache::Get(Device &device, const Pipeline::Params &params)
+    {
+        std::string key = MakeKey(params);
+
+        if (Entry *entry = FindEntry(key))
+        {
+            state.stats.hits++;
+
+            try
+            {
+                return entry->pipeline.Get();
+            }
+            catch (...)
+            {
+                // The asynchronous creation has failed. Forget about it, so that the next call can retry.
+                state.entry_by_key.erase(key);
+                state.entries.pop_front(); // `FindEntry()` has moved it to the front.
+                throw;
+            }
+        }
+
+        state.stats.misses++;
+
+        auto pipeline = std::make_shared<Pipeline>(device, params);
+        AddEntry(std::move(key), AsyncObject<Pipeline>(pipeline));
+        return pipeline;
+    }
+
+    AsyncObject<Pipeline> PipelineCache::GetAsync(AsyncCreator &creator, Device &device, const Pipeline::Params &params)
+    {
+        std::string key = MakeKey(params);
+
+        if (Entry *entry = FindEntry(key))
+        {
+            state.stats.hits++;
+            return entry->pipeline;
+        }
+
+        state.stats.misses++;
+
+        AsyncObject<Pipeline> ret = creator.CreatePipeline(device, params);
+        AddEntry(std::move(key), ret);
+        return ret;
+    }
+
+    void PipelineCache::SetMaxPipelines(std::size_t new_max_pipelines)
+    {
+        state.max_pipelines = new_max_pipelines;
+        EvictOverflow();
+    }
+
+    void PipelineCache::Clear()
+    {
+        state.entry_by_key.clear();
+        state.entries.clear();
+    }
+}
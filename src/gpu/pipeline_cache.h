@@ -0,0 +1,102 @@
+#pragma once
+
+#include "gpu/async_object.h"
+#include "gpu/pipeline.h"
+
+#include <gtl/phmap.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+
+namespace em::Gpu
+{
+    class AsyncCreator;
+    class Device;
+
+    // Shares pipelines with identical parameters, so that they are created only once.
+    // Every `Device` has one of those, see `Device::GetPipelineCache()`. `DynamicPipeline` uses it automatically.
+    //
+    // The key is a serialized copy of the entire `Pipeline::Params`. The shaders are identified by `Shader::UniqueId()`,
+    //   so reloaded shaders get new pipelines, and the old ones are eventually evicted.
+    // When there are more than `max_pipelines` pipelines, the least recently used ones are dropped from the cache.
+    //   The pipelines are returned by `shared_ptr`, so dropping one from the cache doesn't affect the ones that are still in use.
+    // The pipelines can also be created in the background with `GetAsync()`. If `Get()` is then called for one of them, it only waits for the remaining time.
+    // This class itself isn't thread-safe, only use it from the main thread.
+    class PipelineCache
+    {
+      public:
+        struct Stats
+        {
+            std::uint64_t hits = 0;
+            std::uint64_t misses = 0;
+            std::uint64_t evictions = 0;
+        };
+
+      private:
+        struct Entry
+        {
+            std::string key;
+            // This is pending if it was added by `GetAsync()` and isn't created yet.
+            AsyncObject<Pipeline> pipeline;
+        };
+
+        struct State
+        {
+            std::size_t max_pipelines = 256;
+
+            // The most recently used entries are at the front.
+            std::list<Entry> entries;
+            // Points into `entries`. Those iterators are stable.
+            gtl::flat_hash_map<std::string, std::list<Entry>::iterator> entry_by_key;
+
+            Stats stats;
+        };
+        State state;
+
+        void EvictOverflow();
+
+        // Returns the entry with this key, moving it to the front. Or null if there's no such entry.
+        [[nodiscard]] Entry *FindEntry(const std::string &key);
+        void AddEntry(std::string key, AsyncObject<Pipeline> pipeline);
+
+      public:
+        PipelineCache() {}
+
+        PipelineCache(PipelineCache &&other) noexcept
+            : state(std::move(other.state))
+        {
+            other.state = {};
+        }
+        PipelineCache &operator=(PipelineCache other) noexcept
+        {
+            std::swap(state, other.state);
+            return *this;
+        }
+
+        // Serializes the parameters into a string that can be compared and hashed.
+        [[nodiscard]] static std::string MakeKey(const Pipeline::Params &params);
+
+        // Returns an existing pipeline with those parameters, or creates a new one.
+        // If the pipeline is still being created by `GetAsync()`, waits for it.
+        [[nodiscard]] std::shared_ptr<Pipeline> Get(Device &device, const Pipeline::Params &params);
+
+        // Same as `Get()`, but if the pipeline doesn't exist yet, creates it on a worker thread of `creator` and returns immediately.
+        // See `AsyncCreator::CreatePipeline()` for the lifetime requirements.
+        [[nodiscard]] AsyncObject<Pipeline> GetAsync(AsyncCreator &creator, Device &device, const Pipeline::Params &params);
+
+        [[nodiscard]] std::size_t NumPipelines() const {return state.entries.size();}
+
+        [[nodiscard]] std::size_t MaxPipelines() const {return state.max_pipelines;}
+        // Evicts the least recently used pipelines if there's too many now. Zero is allowed, then nothing is cached.
+        void SetMaxPipelines(std::size_t new_max_pipelines);
+
+        // Drops all the pipelines.
+        void Clear();
+
+        [[nodiscard]] const Stats &GetStats() const {return state.stats;}
+        void ResetStats() {state.stats = {};}
+    };
+}
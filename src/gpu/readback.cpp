@@ -0,0 +1,200 @@
+#include "readback.h"
+
+#include "gpu/buffer.h"
+#include "gpu/copy_pass.h"
+#include "gpu/device.h"
+#include "gpu/texture.h"
+
+#include <fmt/format.h>
+#include <SDL3/SDL_gpu.h>
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace em::Gpu
+{
+    bool Readback::Download::IsReady() const
+    {
+        if (!shared)
+            throw std::logic_error("Attempt to use a null `Gpu::Readback::Download`.");
+        return shared->ready;
+    }
+
+    bool Readback::Download::IsCancelled() const
+    {
+        if (!shared)
+            throw std::logic_error("Attempt to use a null `Gpu::Readback::Download`.");
+        return shared->cancelled;
+    }
+
+    const std::vector<unsigned char> &Readback::Download::GetBytes() const
+    {
+        if (!IsReady())
+            throw std::logic_error(IsCancelled() ? "Attempt to read a `Gpu::Readback::Download` whose command buffer was cancelled." : "Attempt to read a `Gpu::Readback::Download` that's not ready yet.");
+        return shared->bytes;
+    }
+
+    mdarray<u8vec4, ivec2> Readback::Download::GetImage() const
+    {
+        const std::vector<unsigned char> &bytes = GetBytes();
+
+        bool is_bgra = false;
+        switch (shared->image_format)
+        {
+          case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM:
+          case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM_SRGB:
+            break;
+          case SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM:
+          case SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM_SRGB:
+            is_bgra = true;
+            break;
+          default:
+            throw std::logic_error("`Gpu::Readback::Download::GetImage()` only supports the 8-bit RGBA and BGRA textures.");
+        }
+
+        mdarray<u8vec4, ivec2> ret(shared->image_size);
+        std::span<u8vec4> pixels = ret.as_flat_array();
+        if (bytes.size() != pixels.size_bytes())
+            throw std::logic_error("The size of the downloaded data doesn't match the image size.");
+
+        std::memcpy(pixels.data(), bytes.data(), bytes.size());
+        if (is_bgra)
+        {
+            for (u8vec4 &pixel : pixels)
+                std::swap(pixel.x, pixel.z);
+        }
+
+        return ret;
+    }
+
+    Readback::Download Readback::AddDownload(TransferBuffer buffer, Callback callback)
+    {
+        if (state.batches.empty())
+            throw std::logic_error("Must call `Gpu::Readback::BeginBatch()` before queueing downloads.");
+
+        PendingDownload &download = state.batches.back().downloads.emplace_back();
+        download.buffer = std::move(buffer);
+        download.result.shared = std::make_shared<Download::Shared>();
+        download.callback = std::move(callback);
+        return download.result;
+    }
+
+    void Readback::FinishBatch(Batch &batch)
+    {
+        for (PendingDownload &download : batch.downloads)
+        {
+            { // Copy the data out. Don't cycle, since that would give us a fresh buffer instead of the downloaded data.
+                TransferBuffer::Mapping mapping = download.buffer.Map(/*cycle=*/false);
+                std::span<const unsigned char> bytes = mapping.AsRangeOf<const unsigned char>();
+                download.result.shared->bytes.assign(bytes.begin(), bytes.end());
+            }
+            download.result.shared->ready = true;
+        }
+
+        // Call the callbacks after everything in this batch is ready, in case they look at several downloads at once.
+        for (PendingDownload &download : batch.downloads)
+        {
+            if (download.callback)
+                download.callback(download.result);
+        }
+    }
+
+    CommandBuffer Readback::BeginBatch(Device &device)
+    {
+        Batch &batch = state.batches.emplace_back();
+        batch.submission = std::make_unique<Submission>();
+        CommandBuffer ret(device, &batch.submission->fence);
+        ret.ReportCancellationTo(&batch.submission->cancelled);
+        return ret;
+    }
+
+    Readback::Download Readback::DownloadBuffer(Device &device, CopyPass &pass, Buffer &buffer, std::uint32_t offset, std::uint32_t size, Callback callback)
+    {
+        TransferBuffer transfer_buffer(device, size, TransferBuffer::Usage::download);
+        transfer_buffer.ApplyToBuffer(pass, 0, buffer, offset, size);
+        return AddDownload(std::move(transfer_buffer), std::move(callback));
+    }
+
+    Readback::Download Readback::DownloadTexture(Device &device, CopyPass &pass, Texture &texture, const TransferBuffer::TextureParams &params, Callback callback)
+    {
+        // Fill the missing size components from the texture, like `TransferBuffer::ApplyToTexture()` does.
+        uvec3 size = params.target_size;
+        if (size.x == 0)
+            size.x = std::uint32_t(texture.GetSize().x);
+        if (size.y == 0)
+            size.y = std::uint32_t(texture.GetSize().y);
+        if (size.z == 0)
+            size.z = std::uint32_t(texture.GetSize().z);
+
+        std::uint32_t texel_size = SDL_GPUTextureFormatTexelBlockSize(texture.GetFormat());
+        if (texel_size == 0)
+            throw std::logic_error("Unable to download a texture with an unknown format.");
+
+        TransferBuffer transfer_buffer(device, size.x * size.y * size.z * texel_size, TransferBuffer::Usage::download);
+        transfer_buffer.ApplyToTexture(pass, texture, {.target_offset = params.target_offset, .target_size = size});
+
+        Download ret = AddDownload(std::move(transfer_buffer), std::move(callback));
+        ret.shared->image_size = size.to_vec2().to<int>();
+        ret.shared->image_format = texture.GetFormat();
+        return ret;
+    }
+
+    void Readback::Update()
+    {
+        // Finish the batches in order, so the callbacks are called in the submission order.
+        // The batches that weren't submitted yet are skipped, since they may still be recording. We must keep them (and their fences) alive
+        //   until their command buffers are destroyed, which tells us whether they were submitted or cancelled.
+        std::vector<Batch> finished;
+        std::vector<Batch> kept;
+        bool waiting_for_gpu = false;
+        for (Batch &batch : state.batches)
+        {
+            Submission &submission = *batch.submission;
+
+            if (submission.cancelled)
+            {
+                for (PendingDownload &download : batch.downloads)
+                    download.result.shared->cancelled = true;
+                continue; // Drop it, its command buffer is gone.
+            }
+
+            // Stop at the first batch that's still executing, to preserve the order.
+            if (!waiting_for_gpu && submission.fence && submission.fence.IsReady())
+                finished.push_back(std::move(batch));
+            else
+            {
+                if (submission.fence)
+                    waiting_for_gpu = true;
+                kept.push_back(std::move(batch));
+            }
+        }
+
+        // Replace the batches before calling the callbacks, since those can call `BeginBatch()`, which modifies `state.batches`.
+        state.batches = std::move(kept);
+
+        for (Batch &batch : finished)
+            FinishBatch(batch);
+    }
+
+    void Readback::WaitAll()
+    {
+        std::vector<Fence *> fences;
+        for (Batch &batch : state.batches)
+            fences.push_back(&batch.submission->fence);
+
+        // This skips the null fences, i.e. the batches that weren't submitted.
+        Fence::WaitAll(fences);
+
+        Update();
+    }
+
+    std::size_t Readback::NumPending() const
+    {
+        std::size_t ret = 0;
+        for (const Batch &batch : state.batches)
+            ret += batch.downloads.size();
+        return ret;
+    }
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "em/math/vector.h"
+#include "gpu/command_buffer.h"
+#include "gpu/fence.h"
+#include "gpu/transfer_buffer.h"
+#include "utils/mdarray.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace em::Gpu
+{
+    class Buffer;
+    class CopyPass;
+    class Device;
+    class Texture;
+
+    // Downloads the contents of buffers and textures from the GPU, without stalling the frame.
+    // Use it for screenshots, GPU picking, or comparing the rendered images in tests.
+    //
+    // Usage:
+    //     Gpu::CommandBuffer cmdbuf = readback.BeginBatch(device);
+    //     Gpu::CopyPass pass(cmdbuf);
+    //     Gpu::Readback::Download d = readback.DownloadTexture(device, pass, texture);
+    //     ... // Destroy the pass and the command buffer to submit them.
+    // Then call `Update()` once per frame, and check `d.IsReady()`, or pass a callback to be called when it's ready.
+    // For tests, `WaitAll()` blocks until everything is downloaded.
+    class Readback
+    {
+      public:
+        // The result of one download.
+        class Download
+        {
+            friend Readback;
+
+            struct Shared
+            {
+                bool ready = false;
+                // The command buffer of this download was cancelled, so it will never be ready.
+                bool cancelled = false;
+                std::vector<unsigned char> bytes;
+
+                // Only for the texture downloads.
+                ivec2 image_size{};
+                SDL_GPUTextureFormat image_format = SDL_GPU_TEXTUREFORMAT_INVALID;
+            };
+            std::shared_ptr<Shared> shared;
+
+          public:
+            constexpr Download() {}
+
+            [[nodiscard]] explicit operator bool() const {return bool(shared);}
+
+            // Doesn't block. This only changes in `Readback::Update()` and `Readback::WaitAll()`.
+            [[nodiscard]] bool IsReady() const;
+            // True if the command buffer of this download was cancelled, so it will never be ready. This changes at the same time as `IsReady()`.
+            [[nodiscard]] bool IsCancelled() const;
+
+            // The downloaded bytes. Throws if not ready.
+            [[nodiscard]] const std::vector<unsigned char> &GetBytes() const;
+
+            // For the texture downloads in the 8-bit RGBA or BGRA formats, returns the image as RGBA. Throws if not ready, or if the format is different.
+            [[nodiscard]] mdarray<u8vec4, ivec2> GetImage() const;
+        };
+
+        // Called from `Update()` or `WaitAll()` when a download finishes.
+        using Callback = std::function<void(const Download &download)>;
+
+      private:
+        struct PendingDownload
+        {
+            TransferBuffer buffer;
+            Download result;
+            Callback callback;
+        };
+
+        // The command buffer from `BeginBatch()` writes to this, so it's stored by pointer to stay in place.
+        struct Submission
+        {
+            // Filled when the command buffer gets submitted.
+            Fence fence;
+            // Set if the command buffer gets cancelled instead.
+            bool cancelled = false;
+        };
+
+        struct Batch
+        {
+            std::unique_ptr<Submission> submission;
+
+            std::vector<PendingDownload> downloads;
+        };
+
+        struct State
+        {
+            // The last one is the current batch, where the new downloads go.
+            std::vector<Batch> batches;
+        };
+        State state;
+
+        [[nodiscard]] Download AddDownload(TransferBuffer buffer, Callback callback);
+
+        // Copies the data out of the transfer buffers, and calls the callbacks.
+        static void FinishBatch(Batch &batch);
+
+      public:
+        Readback() {}
+
+        Readback(Readback &&other) noexcept
+            : state(std::move(other.state))
+        {
+            other.state = {};
+        }
+        Readback &operator=(Readback other) noexcept
+        {
+            std::swap(state, other.state);
+            return *this;
+        }
+
+        // Returns a command buffer for recording the downloads, and starts a new batch. Its completion is tracked by this object.
+        // If this command buffer gets cancelled, its downloads report `IsCancelled()` after the next `Update()`, and their callbacks aren't called.
+        // The batches that weren't submitted yet don't hold back the later ones, so you can record several batches at once.
+        [[nodiscard]] CommandBuffer BeginBatch(Device &device);
+
+        // Those queue a download into `pass`, which must belong to the command buffer returned by the last `BeginBatch()`.
+
+        // Downloads `size` bytes of `buffer` starting at `offset`.
+        [[nodiscard]] Download DownloadBuffer(Device &device, CopyPass &pass, Buffer &buffer, std::uint32_t offset, std::uint32_t size, Callback callback = {});
+
+        // Downloads a region of `texture`. By default downloads the whole first layer of the first mipmap level.
+        // Set `params.target_offset` and `params.target_size` to download a smaller rectangle, e.g. a single pixel for picking. The other parameters are ignored.
+        // Doesn't support the block-compressed formats.
+        [[nodiscard]] Download DownloadTexture(Device &device, CopyPass &pass, Texture &texture, const TransferBuffer::TextureParams &params = {}, Callback callback = {});
+
+        // Doesn't block. Finishes the downloads whose command buffers are done.
+        void Update();
+
+        // Blocks until all the submitted downloads finish.
+        void WaitAll();
+
+        // The number of downloads that didn't finish yet.
+        [[nodiscard]] std::size_t NumPending() const;
+    };
+}
@@ -7,6 +7,7 @@
 #include "gpu/pipeline.h"
 
 #include <concepts>
+#include <stdfloat>
 
 namespace em::Gpu
 {
@@ -90,12 +91,15 @@ namespace em::Gpu
     template <Meta::cvref_unqualified T, bool Norm> requires (sizeof(T) == 2) && Math::unsigned_scalar_bits<Math::vec_base_t<T>, 8> && (Math::vec_size<T> == 2) constexpr SDL_GPUVertexElementFormat vertex_elem_format_for_type_opt<T, Norm> = Norm ? SDL_GPU_VERTEXELEMENTFORMAT_UBYTE2_NORM : SDL_GPU_VERTEXELEMENTFORMAT_UBYTE2;
     template <Meta::cvref_unqualified T, bool Norm> requires (sizeof(T) == 4) && Math::unsigned_scalar_bits<Math::vec_base_t<T>, 8> && (Math::vec_size<T> == 4) constexpr SDL_GPUVertexElementFormat vertex_elem_format_for_type_opt<T, Norm> = Norm ? SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM : SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4;
 
-    template <Meta::cvref_unqualified T, bool Norm> requires (sizeof(T) == 2 * 2) && Math::signed_scalar_bits<Math::vec_base_t<T>, 8> && (Math::vec_size<T> == 2) constexpr SDL_GPUVertexElementFormat vertex_elem_format_for_type_opt<T, Norm> = Norm ? SDL_GPU_VERTEXELEMENTFORMAT_SHORT2_NORM : SDL_GPU_VERTEXELEMENTFORMAT_SHORT2;
-    template <Meta::cvref_unqualified T, bool Norm> requires (sizeof(T) == 2 * 4) && Math::signed_scalar_bits<Math::vec_base_t<T>, 8> && (Math::vec_size<T> == 4) constexpr SDL_GPUVertexElementFormat vertex_elem_format_for_type_opt<T, Norm> = Norm ? SDL_GPU_VERTEXELEMENTFORMAT_SHORT4_NORM : SDL_GPU_VERTEXELEMENTFORMAT_SHORT4;
+    template <Meta::cvref_unqualified T, bool Norm> requires (sizeof(T) == 2 * 2) && Math::signed_scalar_bits<Math::vec_base_t<T>, 16> && (Math::vec_size<T> == 2) constexpr SDL_GPUVertexElementFormat vertex_elem_format_for_type_opt<T, Norm> = Norm ? SDL_GPU_VERTEXELEMENTFORMAT_SHORT2_NORM : SDL_GPU_VERTEXELEMENTFORMAT_SHORT2;
+    template <Meta::cvref_unqualified T, bool Norm> requires (sizeof(T) == 2 * 4) && Math::signed_scalar_bits<Math::vec_base_t<T>, 16> && (Math::vec_size<T> == 4) constexpr SDL_GPUVertexElementFormat vertex_elem_format_for_type_opt<T, Norm> = Norm ? SDL_GPU_VERTEXELEMENTFORMAT_SHORT4_NORM : SDL_GPU_VERTEXELEMENTFORMAT_SHORT4;
 
-    template <Meta::cvref_unqualified T, bool Norm> requires (sizeof(T) == 2 * 2) && Math::unsigned_scalar_bits<Math::vec_base_t<T>, 8> && (Math::vec_size<T> == 2) constexpr SDL_GPUVertexElementFormat vertex_elem_format_for_type_opt<T, Norm> = Norm ? SDL_GPU_VERTEXELEMENTFORMAT_USHORT2_NORM : SDL_GPU_VERTEXELEMENTFORMAT_USHORT2;
-    template <Meta::cvref_unqualified T, bool Norm> requires (sizeof(T) == 2 * 4) && Math::unsigned_scalar_bits<Math::vec_base_t<T>, 8> && (Math::vec_size<T> == 4) constexpr SDL_GPUVertexElementFormat vertex_elem_format_for_type_opt<T, Norm> = Norm ? SDL_GPU_VERTEXELEMENTFORMAT_USHORT4_NORM : SDL_GPU_VERTEXELEMENTFORMAT_USHORT4;
+    template <Meta::cvref_unqualified T, bool Norm> requires (sizeof(T) == 2 * 2) && Math::unsigned_scalar_bits<Math::vec_base_t<T>, 16> && (Math::vec_size<T> == 2) constexpr SDL_GPUVertexElementFormat vertex_elem_format_for_type_opt<T, Norm> = Norm ? SDL_GPU_VERTEXELEMENTFORMAT_USHORT2_NORM : SDL_GPU_VERTEXELEMENTFORMAT_USHORT2;
+    template <Meta::cvref_unqualified T, bool Norm> requires (sizeof(T) == 2 * 4) && Math::unsigned_scalar_bits<Math::vec_base_t<T>, 16> && (Math::vec_size<T> == 4) constexpr SDL_GPUVertexElementFormat vertex_elem_format_for_type_opt<T, Norm> = Norm ? SDL_GPU_VERTEXELEMENTFORMAT_USHORT4_NORM : SDL_GPU_VERTEXELEMENTFORMAT_USHORT4;
 
-    // Not implemented yet: SDL_GPU_VERTEXELEMENTFORMAT_HALF2, SDL_GPU_VERTEXELEMENTFORMAT_HALF4
-    // Waiting for universal `std::float16_t` support...
+    // Half-floats are only available if the compiler supports `std::float16_t`.
+    #if __STDCPP_FLOAT16_T__
+    template <Meta::cvref_unqualified T> requires (sizeof(T) == 2 * 2) && std::same_as<Math::vec_base_t<T>, std::float16_t> && (Math::vec_size<T> == 2) constexpr SDL_GPUVertexElementFormat vertex_elem_format_for_type_opt<T> = SDL_GPU_VERTEXELEMENTFORMAT_HALF2;
+    template <Meta::cvref_unqualified T> requires (sizeof(T) == 2 * 4) && std::same_as<Math::vec_base_t<T>, std::float16_t> && (Math::vec_size<T> == 4) constexpr SDL_GPUVertexElementFormat vertex_elem_format_for_type_opt<T> = SDL_GPU_VERTEXELEMENTFORMAT_HALF4;
+    #endif
 }
@@ -9,6 +9,7 @@
 #include <fmt/format.h>
 #include <SDL3/SDL_gpu.h>
 
+#include <cstddef>
 #include <stdexcept>
 #include <utility>
 
@@ -170,10 +171,55 @@ namespace em::Gpu
         SDL_BindGPUVertexBuffers(state.pass, first_slot, sdl_buffers.data(), std::uint32_t(sdl_buffers.size()));
     }
 
+    void RenderPass::BindIndexBuffer(const IndexBuffer &buffer)
+    {
+        SDL_GPUBufferBinding sdl_buffer{
+            .buffer = buffer.buffer->Handle(),
+            .offset = buffer.byte_offset,
+        };
+
+        // This can't fail.
+        SDL_BindGPUIndexBuffer(state.pass, &sdl_buffer, SDL_GPUIndexElementSize(buffer.index_size));
+    }
+
     void RenderPass::DrawPrimitivesInstanced(std::uint32_t num_vertices, std::uint32_t num_instances, std::uint32_t first_vertex, std::uint32_t first_instance)
     {
         if (num_vertices == 0 || num_instances == 0)
             return; // Just in case. SDL doesn't seem to optimize this, at least not on the backend-agnostic level.
         SDL_DrawGPUPrimitives(state.pass, num_vertices, num_instances, first_vertex, first_instance);
     }
+
+    void RenderPass::DrawIndexedPrimitivesInstanced(std::uint32_t num_indices, std::uint32_t num_instances, std::uint32_t first_index, std::int32_t vertex_offset, std::uint32_t first_instance)
+    {
+        if (num_indices == 0 || num_instances == 0)
+            return; // Just in case, same as in `DrawPrimitivesInstanced()`.
+        SDL_DrawGPUIndexedPrimitives(state.pass, num_indices, num_instances, first_index, vertex_offset, first_instance);
+    }
+
+    // Make sure our indirect draw structs can be copied to the buffers as is.
+    static_assert(sizeof(RenderPass::IndirectDraw) == sizeof(SDL_GPUIndirectDrawCommand));
+    static_assert(offsetof(RenderPass::IndirectDraw, num_vertices) == offsetof(SDL_GPUIndirectDrawCommand, num_vertices));
+    static_assert(offsetof(RenderPass::IndirectDraw, num_instances) == offsetof(SDL_GPUIndirectDrawCommand, num_instances));
+    static_assert(offsetof(RenderPass::IndirectDraw, first_vertex) == offsetof(SDL_GPUIndirectDrawCommand, first_vertex));
+    static_assert(offsetof(RenderPass::IndirectDraw, first_instance) == offsetof(SDL_GPUIndirectDrawCommand, first_instance));
+    static_assert(sizeof(RenderPass::IndirectIndexedDraw) == sizeof(SDL_GPUIndexedIndirectDrawCommand));
+    static_assert(offsetof(RenderPass::IndirectIndexedDraw, num_indices) == offsetof(SDL_GPUIndexedIndirectDrawCommand, num_indices));
+    static_assert(offsetof(RenderPass::IndirectIndexedDraw, num_instances) == offsetof(SDL_GPUIndexedIndirectDrawCommand, num_instances));
+    static_assert(offsetof(RenderPass::IndirectIndexedDraw, first_index) == offsetof(SDL_GPUIndexedIndirectDrawCommand, first_index));
+    static_assert(offsetof(RenderPass::IndirectIndexedDraw, vertex_offset) == offsetof(SDL_GPUIndexedIndirectDrawCommand, vertex_offset));
+    static_assert(offsetof(RenderPass::IndirectIndexedDraw, first_instance) == offsetof(SDL_GPUIndexedIndirectDrawCommand, first_instance));
+
+    void RenderPass::DrawPrimitivesIndirect(Buffer &buffer, std::uint32_t byte_offset, std::uint32_t num_draws)
+    {
+        if (num_draws == 0)
+            return; // Just in case, same as in `DrawPrimitivesInstanced()`.
+        SDL_DrawGPUPrimitivesIndirect(state.pass, buffer.Handle(), byte_offset, num_draws);
+    }
+
+    void RenderPass::DrawIndexedPrimitivesIndirect(Buffer &buffer, std::uint32_t byte_offset, std::uint32_t num_draws)
+    {
+        if (num_draws == 0)
+            return; // Just in case, same as in `DrawPrimitivesInstanced()`.
+        SDL_DrawGPUIndexedPrimitivesIndirect(state.pass, buffer.Handle(), byte_offset, num_draws);
+    }
 }
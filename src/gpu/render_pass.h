@@ -183,9 +183,62 @@ namespace em::Gpu
         void BindVertexBuffers(std::span<const VertexBuffer> buffers, std::uint32_t first_slot = 0);
 
 
+        enum class IndexSize
+        {
+            _16 = SDL_GPU_INDEXELEMENTSIZE_16BIT, // `std::uint16_t`
+            _32 = SDL_GPU_INDEXELEMENTSIZE_32BIT, // `std::uint32_t`
+        };
+
+        struct IndexBuffer
+        {
+            Buffer *buffer = nullptr;
+
+            std::uint32_t byte_offset = 0;
+
+            IndexSize index_size = IndexSize::_16;
+        };
+
+        // Select what index buffer to use. The buffer must be created with `Buffer::Usage::index`.
+        void BindIndexBuffer(const IndexBuffer &buffer);
+
+
         // Drawing:
 
         void DrawPrimitives(std::uint32_t num_vertices, std::uint32_t first_vertex = 0) {DrawPrimitivesInstanced(num_vertices, 1, first_vertex, 0);}
         void DrawPrimitivesInstanced(std::uint32_t num_vertices, std::uint32_t num_instances, std::uint32_t first_vertex = 0, std::uint32_t first_instance = 0);
+
+        // Drawing using the index buffer. `vertex_offset` is added to every index before reading the vertex.
+        void DrawIndexedPrimitives(std::uint32_t num_indices, std::uint32_t first_index = 0, std::int32_t vertex_offset = 0) {DrawIndexedPrimitivesInstanced(num_indices, 1, first_index, vertex_offset, 0);}
+        void DrawIndexedPrimitivesInstanced(std::uint32_t num_indices, std::uint32_t num_instances, std::uint32_t first_index = 0, std::int32_t vertex_offset = 0, std::uint32_t first_instance = 0);
+
+
+        // Indirect drawing, where the draw arguments are read from a buffer created with `Buffer::Usage::indirect`.
+        // The buffer can be filled by the CPU (see `Graphics::MultiDrawBatch`) or by a compute shader.
+        // SDL says non-zero `first_vertex` and `first_instance` don't work consistently with the built-in vertex/instance IDs in shaders, so avoid relying on those.
+
+        // The layout of one draw in the buffer for `DrawPrimitivesIndirect()`. Same as `SDL_GPUIndirectDrawCommand`.
+        struct IndirectDraw
+        {
+            std::uint32_t num_vertices = 0;
+            std::uint32_t num_instances = 1;
+            std::uint32_t first_vertex = 0;
+            std::uint32_t first_instance = 0;
+        };
+
+        // The layout of one draw in the buffer for `DrawIndexedPrimitivesIndirect()`. Same as `SDL_GPUIndexedIndirectDrawCommand`.
+        struct IndirectIndexedDraw
+        {
+            std::uint32_t num_indices = 0;
+            std::uint32_t num_instances = 1;
+            std::uint32_t first_index = 0;
+            // This is added to every index before reading the vertex.
+            std::int32_t vertex_offset = 0;
+            std::uint32_t first_instance = 0;
+        };
+
+        // Performs `num_draws` draws, reading `IndirectDraw`s tightly packed starting at `byte_offset` in `buffer`.
+        void DrawPrimitivesIndirect(Buffer &buffer, std::uint32_t byte_offset, std::uint32_t num_draws);
+        // Performs `num_draws` draws using the index buffer, reading `IndirectIndexedDraw`s tightly packed starting at `byte_offset` in `buffer`.
+        void DrawIndexedPrimitivesIndirect(Buffer &buffer, std::uint32_t byte_offset, std::uint32_t num_draws);
     };
 }
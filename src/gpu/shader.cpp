@@ -11,6 +11,7 @@
 #include <SDL3_shadercross/SDL_shadercross.h>
 #include <SDL3/SDL_gpu.h>
 
+#include <atomic>
 #include <stdexcept>
 
 namespace em::Gpu
@@ -27,6 +28,8 @@ namespace em::Gpu
           case Stage::fragment:
             shadercross_stage = SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT;
             break;
+          case Stage::compute:
+            throw std::logic_error("Compute shaders must be created as `Gpu::ComputePipeline`s, not `Gpu::Shader`s.");
           default:
             throw std::logic_error("Invalid shader stage enum.");
         }
@@ -60,6 +63,9 @@ namespace em::Gpu
         state.shader = SDL_ShaderCross_CompileGraphicsShaderFromSPIRV(device.Handle(), &input, &reflected_metadata->resource_info, 0);
         if (!state.shader)
             throw std::runtime_error(fmt::format("Unable to compile SPIRV shader: {}", SDL_GetError()));
+
+        static std::atomic<std::uint64_t> next_id = 1;
+        state.id = next_id++;
     }
 
     Shader::Shader(Shader &&other) noexcept
@@ -91,6 +97,9 @@ namespace em::Gpu
           case Stage::fragment:
             SDL_PushGPUFragmentUniformData(cmdbuf.Handle(), slot, bytes.data(), std::uint32_t(bytes.size()));
             return;
+          case Stage::compute:
+            SDL_PushGPUComputeUniformData(cmdbuf.Handle(), slot, bytes.data(), std::uint32_t(bytes.size()));
+            return;
         }
 
         throw std::logic_error("Invalid shader stage enum.");
@@ -118,6 +127,8 @@ namespace em::Gpu
           case Shader::Stage::fragment:
             SDL_BindGPUFragmentSamplers(render_pass.Handle(), first_slot, sdl_textures.data(), std::uint32_t(sdl_textures.size()));
             break;
+          case Shader::Stage::compute:
+            throw std::logic_error("Use `ComputePass::BindSamplers()` to bind textures for compute shaders.");
           default:
             throw std::logic_error("Invalid shader stage enum.");
         }
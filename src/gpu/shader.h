@@ -26,6 +26,9 @@ namespace em::Gpu
             // This can't be `Device *` to keep the address stable.
             SDL_GPUDevice *device = nullptr;
             SDL_GPUShader *shader = nullptr;
+
+            // See `UniqueId()`.
+            std::uint64_t id = 0;
         };
         State state;
 
@@ -36,10 +39,12 @@ namespace em::Gpu
         {
             vertex,
             fragment,
-            // Adding compute support needs too much special-casing, so I'll add it when I need it. It should probably go into a separate class.
+            // Compute shaders can't be `Shader`s, since SDL creates `ComputePipeline`s directly from the shader code.
+            // This is here for `SetUniform()`, and for the code that handles all shader kinds uniformly (`ShaderManager`, the compilers).
+            compute,
         };
 
-        // The name is optional.
+        // The name is optional. `stage` can't be `compute`, use `ComputePipeline` for that.
         Shader(Device &device, zstring_view name, Stage stage, const_byte_view spirv_binary);
 
         Shader(Shader &&other) noexcept;
@@ -49,12 +54,17 @@ namespace em::Gpu
         [[nodiscard]] explicit operator bool() const {return bool(state.shader);}
         [[nodiscard]] SDL_GPUShader *Handle() {return state.shader;}
 
+        // A number that's different for every shader ever created by this process, or 0 for null shaders.
+        // Unlike `Handle()`, this is never reused, so this can be used to detect that a shader was replaced (e.g. reloaded) in place.
+        [[nodiscard]] std::uint64_t UniqueId() const {return state.id;}
+
         // Sets the uniform value.
         // SDL says this survives to the end of the current command buffer (https://wiki.libsdl.org/SDL3/CategoryGPU#uniform-data).
         // SDL says if you pass a struct, you must follow std140 layout. Among other things `vec3` and `vec4` must be 16 byte aligned.
         //   I assume the alignment is relative to the start of the buffer, not necessarily in the actual RAM.
         // In vertex shaders use: `uniform(set = 1, binding = MySlotIndex) uniform MyUniforms {...}`.
         // In fragment shaders use: `uniform(set = 3, binding = MySlotIndex) uniform MyUniforms {...}`.
+        // In compute shaders use: `uniform(set = 2, binding = MySlotIndex) uniform MyUniforms {...}`.
         // NOTE: SDL says it's fine to call this both outside of passes and DURING render passes (or compute passes).
         // The slot indices are independent per stage, and SDL says you have 4 slots per stage (https://wiki.libsdl.org/SDL3/CategoryGPU#uniform-data).
         // `glslc` rejects standalone uniforms (as opposed to struct-like `{...}`), other than samplers.
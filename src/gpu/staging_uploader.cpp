@@ -0,0 +1,145 @@
+#include "staging_uploader.h"
+
+#include "gpu/copy_pass.h"
+#include "gpu/device.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace em::Gpu
+{
+    StagingUploader::PendingCopy StagingUploader::Stage(Device &device, const_byte_view data, std::uint32_t alignment)
+    {
+        if (state.params.chunk_size == 0)
+            throw std::logic_error("Attempt to use a null `Gpu::StagingUploader`.");
+
+        std::uint32_t size = std::uint32_t(data.size());
+
+        auto AlignUp = [&](std::uint32_t offset)
+        {
+            return (offset + alignment - 1) / alignment * alignment;
+        };
+
+        // Find a chunk with enough free space. Skip the current chunk if it's full, reusing the chunks from the previous flushes.
+        std::uint32_t offset = 0;
+        while (true)
+        {
+            if (state.cur_chunk < state.chunks.size())
+            {
+                Chunk &chunk = state.chunks[state.cur_chunk];
+                offset = AlignUp(chunk.used_bytes);
+                if (std::uint64_t(offset) + size <= chunk.buffer.Size())
+                    break;
+
+                // Doesn't fit. If the current chunk is empty, don't waste it, and insert a dedicated chunk before it instead.
+                if (chunk.used_bytes == 0 && size > state.params.chunk_size)
+                {
+                    state.mapping = {};
+                    state.chunks.insert(state.chunks.begin() + std::ptrdiff_t(state.cur_chunk), Chunk{.buffer = TransferBuffer(device, size), .dedicated = true});
+                    offset = 0;
+                    break;
+                }
+
+                state.mapping = {};
+                state.cur_chunk++;
+                continue;
+            }
+
+            // Out of chunks, make a new one.
+            bool dedicated = size > state.params.chunk_size;
+            state.chunks.push_back({.buffer = TransferBuffer(device, dedicated ? size : state.params.chunk_size), .dedicated = dedicated});
+            offset = 0;
+            break;
+        }
+
+        Chunk &chunk = state.chunks[state.cur_chunk];
+
+        // Cycle on the first map after a flush, in case the previous uploads from this chunk are still in flight.
+        // This also happens to be harmless for the freshly created chunks.
+        if (!state.mapping)
+            state.mapping = chunk.buffer.Map(/*cycle=*/chunk.used_bytes == 0);
+
+        std::memcpy(state.mapping.AsRangeOf<unsigned char>().data() + offset, data.data(), size);
+        chunk.used_bytes = offset + size;
+
+        return {.chunk_index = state.cur_chunk, .offset_in_chunk = offset};
+    }
+
+    StagingUploader::StagingUploader(const Params &params)
+    {
+        if (params.chunk_size == 0)
+            throw std::logic_error("The chunk size of a `Gpu::StagingUploader` can't be zero.");
+
+        state.params = params;
+    }
+
+    void StagingUploader::UploadToBuffer(Device &device, const_byte_view data, Buffer &target, std::uint32_t target_offset, bool cycle)
+    {
+        if (data.empty())
+            return;
+
+        PendingCopy copy = Stage(device, data, buffer_alignment);
+        copy.copy = BufferCopy{
+            .target = Buffer(Buffer::ViewExternalHandle{}, device.Handle(), target.Handle()),
+            .target_offset = target_offset,
+            .size = std::uint32_t(data.size()),
+            .cycle = cycle,
+        };
+        state.pending.push_back(std::move(copy));
+    }
+
+    void StagingUploader::UploadToTexture(Device &device, const_byte_view data, Texture &target, const TransferBuffer::TextureParams &params)
+    {
+        if (data.empty())
+            return;
+
+        PendingCopy copy = Stage(device, data, texture_alignment);
+        copy.copy = TextureCopy{
+            .target = Texture(Texture::ViewExternalHandle{}, device.Handle(), target.Handle(), target.GetSize(), target.GetFormat(), target.GetType()),
+            .params = params,
+        };
+        state.pending.push_back(std::move(copy));
+    }
+
+    void StagingUploader::DiscardPendingSince(std::size_t num_pending)
+    {
+        if (num_pending > state.pending.size())
+            throw std::logic_error("`Gpu::StagingUploader::DiscardPendingSince()` received more uploads than there are pending.");
+
+        state.pending.erase(state.pending.begin() + std::ptrdiff_t(num_pending), state.pending.end());
+    }
+
+    void StagingUploader::Flush(CopyPass &pass)
+    {
+        // The transfer buffers must be unmapped before they're used.
+        state.mapping = {};
+
+        for (PendingCopy &pending : state.pending)
+        {
+            TransferBuffer &source = state.chunks[pending.chunk_index].buffer;
+
+            std::visit([&](auto &copy)
+            {
+                if constexpr (std::is_same_v<std::remove_cvref_t<decltype(copy)>, BufferCopy>)
+                {
+                    source.ApplyToBuffer(pass, pending.offset_in_chunk, copy.target, copy.target_offset, copy.size, copy.cycle);
+                }
+                else
+                {
+                    TransferBuffer::TextureParams params = copy.params;
+                    params.self_byte_offset += pending.offset_in_chunk;
+                    source.ApplyToTexture(pass, copy.target, params);
+                }
+            }, pending.copy);
+        }
+        state.pending.clear();
+
+        // Drop the dedicated chunks, and rewind the rest. SDL destroys the dropped ones lazily, after the copies finish.
+        std::erase_if(state.chunks, [](const Chunk &chunk){return chunk.dedicated;});
+        for (Chunk &chunk : state.chunks)
+            chunk.used_bytes = 0;
+        state.cur_chunk = 0;
+    }
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "gpu/buffer.h"
+#include "gpu/texture.h"
+#include "gpu/transfer_buffer.h"
+#include "utils/byte_view.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <variant>
+#include <vector>
+
+namespace em::Gpu
+{
+    class CopyPass;
+    class Device;
+
+    // Batches many uploads to buffers and textures through a few large, reused transfer buffers, instead of creating a transfer buffer per upload.
+    // Queue the uploads with `UploadToBuffer()` and `UploadToTexture()` (or with the `Buffer` and `Texture` constructors that accept this),
+    //   then call `Flush()` to record all of them into one copy pass.
+    //
+    // The data is copied into the transfer buffers immediately, so it doesn't have to outlive the call.
+    // The transfer buffers (chunks) are kept between the flushes, and are cycled when reused, so flushing every frame is fine.
+    // The targets are remembered by their SDL handles, so they can be moved before the flush, but must not be destroyed.
+    class StagingUploader
+    {
+      public:
+        struct Params
+        {
+            // The size of each transfer buffer. Uploads larger than this get a temporary dedicated transfer buffer.
+            std::uint32_t chunk_size = 16 << 20;
+        };
+
+        // Texture uploads must start at a multiple of the texel block size, and this covers every format (block-compressed formats have 16-byte blocks).
+        static constexpr std::uint32_t texture_alignment = 16;
+        // Buffer uploads only need 4 bytes, at least on some backends.
+        static constexpr std::uint32_t buffer_alignment = 4;
+
+      private:
+        struct BufferCopy
+        {
+            Buffer target; // A non-owning view.
+            std::uint32_t target_offset = 0;
+            std::uint32_t size = 0;
+            bool cycle = false;
+        };
+
+        struct TextureCopy
+        {
+            Texture target; // A non-owning view.
+            TransferBuffer::TextureParams params;
+        };
+
+        struct PendingCopy
+        {
+            std::size_t chunk_index = 0;
+            std::uint32_t offset_in_chunk = 0;
+            std::variant<BufferCopy, TextureCopy> copy;
+        };
+
+        struct Chunk
+        {
+            TransferBuffer buffer;
+            std::uint32_t used_bytes = 0;
+
+            // Dedicated chunks hold a single large upload, and are destroyed after the flush.
+            bool dedicated = false;
+        };
+
+        struct State
+        {
+            Params params;
+
+            std::vector<Chunk> chunks;
+            // The chunk we're currently writing to. The chunks before it are full.
+            std::size_t cur_chunk = 0;
+            // The mapping of `chunks[cur_chunk]`, if any.
+            TransferBuffer::Mapping mapping;
+
+            std::vector<PendingCopy> pending;
+        };
+        State state;
+
+        // Copies `data` into a chunk, and returns where it landed.
+        [[nodiscard]] PendingCopy Stage(Device &device, const_byte_view data, std::uint32_t alignment);
+
+      public:
+        StagingUploader() {}
+
+        explicit StagingUploader(const Params &params);
+
+        StagingUploader(StagingUploader &&other) noexcept
+            : state(std::move(other.state))
+        {
+            other.state = {};
+        }
+        StagingUploader &operator=(StagingUploader other) noexcept
+        {
+            std::swap(state, other.state);
+            return *this;
+        }
+
+        // Queues an upload of `data` into `target` at `target_offset`.
+        // Cycling is disabled by default, because it would discard the other uploads to the same buffer. See `gpu/README-cycling.md`.
+        void UploadToBuffer(Device &device, const_byte_view data, Buffer &target, std::uint32_t target_offset = 0, bool cycle = false);
+
+        // Queues an upload of `data` into `target`. `params.self_byte_offset` and `params.self_size` describe the image in `data`, like for `TransferBuffer`.
+        // Note that `params.cycle` defaults to true, which is fine when replacing the whole texture, but not when uploading several sub-rects.
+        void UploadToTexture(Device &device, const_byte_view data, Texture &target, const TransferBuffer::TextureParams &params = {});
+
+        // The number of uploads waiting for `Flush()`.
+        [[nodiscard]] std::size_t NumPending() const {return state.pending.size();}
+
+        // Drops the uploads queued after `NumPending()` returned `num_pending`, e.g. if creating the target has failed halfway and it's being destroyed.
+        // The staging space they took isn't reclaimed until the next `Flush()`.
+        void DiscardPendingSince(std::size_t num_pending);
+
+        // The number of transfer buffers currently allocated.
+        [[nodiscard]] std::size_t NumChunks() const {return state.chunks.size();}
+
+        // Records all queued uploads into `pass`.
+        void Flush(CopyPass &pass);
+    };
+}
@@ -1,6 +1,7 @@
 #include "texture.h"
 
 #include "gpu/device.h"
+#include "gpu/staging_uploader.h"
 #include "gpu/transfer_buffer.h"
 
 #include <fmt/format.h>
@@ -43,6 +44,12 @@ namespace em::Gpu
         tb.ApplyToTexture(pass, *this);
     }
 
+    Texture::Texture(Device &device, StagingUploader &uploader, const Image &image, UsageFlags usage)
+        : Texture(device, Params{.usage = usage, .size = image.pixels.size().to_vec3(1)})
+    {
+        uploader.UploadToTexture(device, image.pixels.as_flat_array(), *this);
+    }
+
     Texture::Texture(ViewExternalHandle, SDL_GPUDevice *device, SDL_GPUTexture *handle, ivec3 size, SDL_GPUTextureFormat format, Type type)
     {
         if (handle)
@@ -7,10 +7,13 @@
 
 #include <SDL3/SDL_gpu.h>
 
+#include <algorithm>
+
 namespace em::Gpu
 {
     class CopyPass;
     class Device;
+    class StagingUploader;
 
     // A texture.
     class Texture
@@ -96,6 +99,8 @@ namespace em::Gpu
 
         // This automatically creates a transfer buffer and uploads the image using it.
         Texture(Device &device, CopyPass &pass, const Image &image, UsageFlags usage = UsageFlags::sampler);
+        // Same, but queues the upload into `uploader`, to be batched with other uploads. The texture must not be used until `uploader.Flush()`.
+        Texture(Device &device, StagingUploader &uploader, const Image &image, UsageFlags usage = UsageFlags::sampler);
 
         struct ViewExternalHandle {explicit ViewExternalHandle() = default;};
         // Put an existing handle into a texture, and don't free it when destroyed. Need this for swapchain textures.
@@ -113,6 +118,13 @@ namespace em::Gpu
         // Returns the size. The third dimension will be 1 for 2D textures.
         [[nodiscard]] ivec3 GetSize() const {return state.size;}
 
+        // Returns the size of a mipmap level. This doesn't reduce the number of layers for the array and cube textures, only the depth of the 3D textures.
+        [[nodiscard]] ivec3 GetMipmapSize(int level) const
+        {
+            auto Reduce = [&](int value){return std::max(1, value >> level);};
+            return ivec3(Reduce(state.size.x), Reduce(state.size.y), state.type == Type::three_dim ? Reduce(state.size.z) : state.size.z);
+        }
+
         [[nodiscard]] Type GetType() const {return state.type;}
 
         [[nodiscard]] SDL_GPUTextureFormat GetFormat() const {return state.format;}
@@ -75,14 +75,13 @@ namespace em::Gpu
 
     // Maps the buffer into memory temporarily.
     // It gets unmapped when the returned object dies.
-    TransferBuffer::Mapping TransferBuffer::Map()
+    TransferBuffer::Mapping TransferBuffer::Map(bool cycle)
     {
         Mapping ret;
         ret.state.device = state.device;
         ret.state.buffer = state.buffer;
 
-        // Here we always cycle. Not sure why we wouldn't want to.
-        void *address = SDL_MapGPUTransferBuffer(state.device, state.buffer, /*cycle:*/true);
+        void *address = SDL_MapGPUTransferBuffer(state.device, state.buffer, cycle);
         if (!address)
             throw std::runtime_error(fmt::format("Failed to map a GPU transfer buffer: {}", SDL_GetError()));
 
@@ -90,14 +89,14 @@ namespace em::Gpu
         return ret;
     }
 
-    void TransferBuffer::LoadFromMemory(const unsigned char *source)
+    void TransferBuffer::LoadFromMemory(const unsigned char *source, bool cycle)
     {
-        Mapping m = Map();
+        Mapping m = Map(cycle);
         auto bytes = m.AsRangeOf<char>();
         std::memcpy(bytes.data(), source, bytes.size());
     }
 
-    void TransferBuffer::ApplyToBuffer(CopyPass &pass, std::uint32_t self_offset, Buffer &target, std::uint32_t target_offset, std::uint32_t size)
+    void TransferBuffer::ApplyToBuffer(CopyPass &pass, std::uint32_t self_offset, Buffer &target, std::uint32_t target_offset, std::uint32_t size, bool cycle)
     {
         if (size == 0)
             return; // SDL doesn't seem to do this optimization, at least not in the backend-agnostic part.
@@ -119,8 +118,7 @@ namespace em::Gpu
         }
         else
         {
-            // Here we always cycle. Not sure why we wouldn't want to.
-            SDL_UploadToGPUBuffer(pass.Handle(), &self_loc, &target_loc, /*cycle=*/true);
+            SDL_UploadToGPUBuffer(pass.Handle(), &self_loc, &target_loc, cycle);
         }
     }
 
@@ -136,6 +134,10 @@ namespace em::Gpu
         // Not entirely sure about this. See: https://github.com/libsdl-org/SDL/issues/12746
         bool is_layered = Texture::TypeIsLayered(target.GetType());
 
+        // Smaller mipmaps have smaller sizes. This matters for block-compressed formats too, where the last mipmaps are smaller than a block:
+        //   the region must then use the real mipmap size, not the block size.
+        const ivec3 mipmap_size = target.GetMipmapSize(int(params.mipmap_layer));
+
         SDL_GPUTextureRegion target_loc{
             .texture = target.Handle(),
             .mip_level = params.mipmap_layer,
@@ -143,11 +145,11 @@ namespace em::Gpu
             .x = params.target_offset.x,
             .y = params.target_offset.y,
             .z = params.target_offset.z,
-            .w = params.target_size.x ? params.target_size.x : std::uint32_t(target.GetSize().x),
-            .h = params.target_size.y ? params.target_size.y : std::uint32_t(target.GetSize().y),
+            .w = params.target_size.x ? params.target_size.x : std::uint32_t(mipmap_size.x),
+            .h = params.target_size.y ? params.target_size.y : std::uint32_t(mipmap_size.y),
             // We are not adding `is_layered ? 1 : ...` here, to hopefully make SDL assert if someone tries to pass `depth != 1` for a layered texture,
             //   which is illegal.
-            .d = params.target_size.z ? params.target_size.z : std::uint32_t(target.GetSize().z),
+            .d = params.target_size.z ? params.target_size.z : std::uint32_t(mipmap_size.z),
         };
 
         // Those functions can't fail.
@@ -157,8 +159,7 @@ namespace em::Gpu
         }
         else
         {
-            // Here we always cycle. Not sure why we wouldn't want to.
-            SDL_UploadToGPUTexture(pass.Handle(), &self_loc, &target_loc, /*cycle=*/true);
+            SDL_UploadToGPUTexture(pass.Handle(), &self_loc, &target_loc, params.cycle);
         }
     }
 }
@@ -78,6 +78,8 @@ namespace em::Gpu
             Mapping &operator=(Mapping other) noexcept;
             ~Mapping();
 
+            [[nodiscard]] explicit operator bool() const {return bool(state.buffer);}
+
             // Returns the mapped region.
             // This is const, because this class is modelled like a pointer.
             template <mut_byte_view_reinterpretable_as_range_of T>
@@ -87,17 +89,20 @@ namespace em::Gpu
         // Maps the buffer into memory temporarily. Throws on failure.
         // It gets unmapped when the returned object dies.
         // Call `.Span()` on the result to get the mapped pointer.
-        [[nodiscard]] Mapping Map();
+        // `cycle` is explained in `README-cycling.md`. Only disable it if you know that the GPU is done with this buffer,
+        //   e.g. if you have one buffer per frame in flight (see `FrameContext`). Otherwise you'll overwrite the data that's still being used.
+        [[nodiscard]] Mapping Map(bool cycle = true);
 
         // A wrapper for `Map()` that fills the buffer from the passed pointer.
-        void LoadFromMemory(const unsigned char *source);
+        void LoadFromMemory(const unsigned char *source, bool cycle = true);
 
         // Upload to a buffer or download from it (depending on constructor parameters).
         // You can assume that the upload finishes immediately, but for downloads YOU MUST WAIT for the command buffer fence.
-        // NOTE: Uploading to a buffer cycles it (which is optional in SDL, but we always do it, not sure why you wouldn't).
+        // NOTE: Uploading to a buffer cycles it by default (see `README-cycling.md`).
         //   This makes `RenderPass::BindVertexBuffers()` stale, you must call it again on the freshly uploaded buffer.
+        //   When filling one buffer with several uploads, only cycle on the first one, otherwise each upload discards the previous ones.
         void ApplyToBuffer(CopyPass &pass, Buffer &target) {ApplyToBuffer(pass, 0, target, 0, Size());}
-        void ApplyToBuffer(CopyPass &pass, std::uint32_t self_offset, Buffer &target, std::uint32_t target_offset, std::uint32_t size);
+        void ApplyToBuffer(CopyPass &pass, std::uint32_t self_offset, Buffer &target, std::uint32_t target_offset, std::uint32_t size, bool cycle = true);
 
         struct TextureParams
         {
@@ -108,16 +113,21 @@ namespace em::Gpu
             // When uploading to a part of the texture, this is the offset in the texture.
             uvec3 target_offset{};
 
-            // The image size. If zero, will use the texture size (the components can be zeroed individually).
+            // The image size. If zero, will use the texture size at `mipmap_layer` (the components can be zeroed individually).
             // For layered textures, it's illegal to upload more than one layer at a time: https://github.com/libsdl-org/SDL/issues/12746#issuecomment-2781171335
             uvec3 target_size{};
 
             std::uint32_t self_byte_offset = 0;
 
             // When the buffer holds a larger image and you want to deal with its subimage, set this to the size of the larger image. Measured in pixels.
+            // For block-compressed formats this is still in pixels, but must be a multiple of the block size. When this is zero, SDL rounds up the rows to whole blocks.
             // Keep this zero to match the `target_size` (or if that is zero too, the texture size). The components can be zeroed individually.
             // The Y component isn't needed unless you're dealing with 3D textures (or arrays of 2D textures), I believe.
             uvec2 self_size{};
+
+            // Only for uploads. See `gpu/README-cycling.md`.
+            // Cycling discards the old contents of the texture if it's still in use, so disable it when uploading only to a part of the texture.
+            bool cycle = true;
         };
 
         // Upload to a texture or download from it (depending on constructor parameters).
@@ -0,0 +1,227 @@
+#include "asset_loader.h"
+
+#include "gpu/command_buffer.h"
+#include "gpu/compressed_image.h"
+#include "gpu/copy_pass.h"
+#include "gpu/device.h"
+#include "utils/filesystem.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <iterator>
+
+namespace em::Graphics
+{
+    void AssetLoader::WorkerStep(Shared &shared)
+    {
+        Task task;
+        {
+            std::lock_guard lock(shared.mutex);
+            // The queue can be empty if the loader is being destroyed, see the destructor.
+            if (shared.queue.empty())
+                return;
+            std::pop_heap(shared.queue.begin(), shared.queue.end(), TaskLess{});
+            task = std::move(shared.queue.back());
+            shared.queue.pop_back();
+        }
+
+        Finished finished{.request = task.request};
+
+        if (!task.request->cancelled)
+        {
+            try
+            {
+                blob data;
+                if (std::optional<blob> archived = shared.archive ? shared.archive->TryGet(task.name) : std::nullopt)
+                    data = std::move(*archived);
+                else
+                    data = Filesystem::FileContents(Filesystem::GetResourcePath(task.name));
+
+                finished.func = task.process(std::move(data));
+            }
+            catch (...)
+            {
+                try
+                {
+                    std::throw_with_nested(std::runtime_error(fmt::format("While loading asset `{}`:", task.name)));
+                }
+                catch (...)
+                {
+                    finished.exception = std::current_exception();
+                }
+            }
+        }
+
+        std::lock_guard lock(shared.mutex);
+        shared.finished.push_back(std::move(finished));
+    }
+
+    void AssetLoader::QueueTask(std::string name, int priority, std::shared_ptr<detail::AssetRequestState> request, std::function<MainThreadFunc(blob data)> process)
+    {
+        if (!*this)
+            throw std::logic_error("Attempt to use a null `Graphics::AssetLoader`.");
+
+        {
+            std::lock_guard lock(state.shared->mutex);
+            state.shared->queue.push_back({
+                .priority = priority,
+                .sequence = state.next_sequence++,
+                .name = std::move(name),
+                .request = std::move(request),
+                .process = std::move(process),
+            });
+            std::push_heap(state.shared->queue.begin(), state.shared->queue.end(), TaskLess{});
+        }
+
+        // Every step takes the highest priority task at the time it starts, not this specific one.
+        state.thread_pool.Run([shared = state.shared.get()]{WorkerStep(*shared);});
+        state.num_pending++;
+    }
+
+    AssetLoader::AssetLoader(const Params &params)
+    {
+        state.params = params;
+        state.shared = std::make_unique<Shared>();
+        state.shared->archive = params.archive;
+        state.thread_pool = ThreadPool(params.num_threads);
+        state.uploader = Gpu::StagingUploader(params.uploader_params);
+    }
+
+    AssetLoader::~AssetLoader()
+    {
+        if (!state.shared)
+            return;
+
+        // Drop the tasks that weren't started. The remaining worker steps will find the queue empty and do nothing.
+        std::lock_guard lock(state.shared->mutex);
+        state.shared->queue.clear();
+
+        // Then the thread pool destructor waits for the running tasks.
+    }
+
+    AssetRequest<blob> AssetLoader::LoadBytes(std::string name, int priority)
+    {
+        return Load<blob>(std::move(name), [](blob data){return data;}, priority);
+    }
+
+    AssetRequest<Image> AssetLoader::LoadImage(std::string name, int priority)
+    {
+        return Load<Image>(name, [name](blob data){return Image(name, data);}, priority);
+    }
+
+    AssetRequest<Gpu::Texture> AssetLoader::LoadTexture(std::string name, int priority, Gpu::Texture::UsageFlags usage)
+    {
+        auto shared = std::make_shared<AssetRequest<Gpu::Texture>::Shared>();
+        QueueTask(name, priority, shared, [shared, name, usage](blob data) -> MainThreadFunc
+        {
+            // The block-compressed textures are uploaded as is, only the level table is parsed here.
+            if (Gpu::CompressedImage::Matches(data))
+            {
+                auto compressed = std::make_shared<Gpu::CompressedImage>(name, data);
+
+                return [shared, compressed, usage](Gpu::Device &device, Gpu::StagingUploader &uploader) -> std::size_t
+                {
+                    shared->value.emplace(compressed->CreateTexture(device, uploader, usage));
+
+                    std::size_t bytes = 0;
+                    for (int i = 0; i < compressed->NumLevels(); i++)
+                        bytes += compressed->GetLevel(i).size();
+                    return bytes;
+                };
+            }
+
+            // Decode on the worker thread.
+            auto image = std::make_shared<Image>(name, data);
+
+            // Create and upload on the main thread.
+            return [shared, image, usage](Gpu::Device &device, Gpu::StagingUploader &uploader) -> std::size_t
+            {
+                shared->value.emplace(device, uploader, *image, usage);
+                return image->pixels.flat_size() * sizeof(u8vec4);
+            };
+        });
+        return AssetRequest<Gpu::Texture>(std::move(shared));
+    }
+
+    std::size_t AssetLoader::Update(Gpu::Device &device)
+    {
+        if (!*this)
+            throw std::logic_error("Attempt to use a null `Graphics::AssetLoader`.");
+
+        {
+            std::lock_guard lock(state.shared->mutex);
+            std::move(state.shared->finished.begin(), state.shared->finished.end(), std::back_inserter(state.finished));
+            state.shared->finished.clear();
+        }
+
+        // Those become ready after the uploads are submitted.
+        std::vector<std::shared_ptr<detail::AssetRequestState>> uploaded_requests;
+        std::size_t num_uploaded_bytes = 0;
+        std::size_t ret = 0;
+
+        while (!state.finished.empty() && (uploaded_requests.empty() || num_uploaded_bytes < state.params.max_upload_bytes_per_update))
+        {
+            Finished finished = std::move(state.finished.front());
+            state.finished.pop_front();
+            state.num_pending--;
+
+            detail::AssetRequestState &request = *finished.request;
+            if (request.cancelled)
+                continue; // The status was already set by `AssetRequest::Cancel()`.
+
+            ret++;
+
+            if (!finished.exception)
+            {
+                // If `func` throws after queueing some uploads, those target a texture that's already destroyed, so we drop them.
+                const std::size_t num_pending_uploads = state.uploader.NumPending();
+
+                try
+                {
+                    const std::size_t num_bytes = finished.func(device, state.uploader);
+                    if (num_bytes > 0)
+                    {
+                        num_uploaded_bytes += num_bytes;
+                        uploaded_requests.push_back(finished.request);
+                    }
+                    else
+                    {
+                        request.status = AssetStatus::ready;
+                    }
+                    continue;
+                }
+                catch (...)
+                {
+                    state.uploader.DiscardPendingSince(num_pending_uploads);
+                    finished.exception = std::current_exception();
+                }
+            }
+
+            request.exception = finished.exception;
+            request.status = AssetStatus::failed;
+        }
+
+        if (state.uploader.NumPending() > 0)
+        {
+            Gpu::CommandBuffer cmdbuf(device);
+            Gpu::CopyPass copy_pass(cmdbuf);
+            state.uploader.Flush(copy_pass);
+        }
+
+        // The uploads are submitted at this point, so any command buffer submitted after this can use the textures.
+        for (const auto &request : uploaded_requests)
+            request->status = AssetStatus::ready;
+
+        return ret;
+    }
+
+    void AssetLoader::WaitUntilIdle(Gpu::Device &device)
+    {
+        while (NumPending() > 0)
+        {
+            state.thread_pool.WaitUntilIdle();
+            Update(device);
+        }
+    }
+}
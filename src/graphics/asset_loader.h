@@ -0,0 +1,282 @@
+#pragma once
+
+#include "gpu/staging_uploader.h"
+#include "gpu/texture.h"
+#include "utils/asset_archive.h"
+#include "utils/blob.h"
+#include "utils/image.h"
+#include "utils/thread_pool.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace em::Gpu
+{
+    class Device;
+}
+
+namespace em::Graphics
+{
+    class AssetLoader;
+
+    enum class AssetStatus
+    {
+        pending, // Queued or being loaded.
+        ready,
+        failed,
+        cancelled,
+    };
+
+    namespace detail
+    {
+        // The part of the `AssetRequest` state that doesn't depend on the asset type.
+        struct AssetRequestState
+        {
+            // This is checked by the worker threads, to skip the cancelled requests.
+            std::atomic<bool> cancelled = false;
+
+            // The rest is only accessed on the main thread.
+            AssetStatus status = AssetStatus::pending;
+            std::exception_ptr exception;
+        };
+    }
+
+    // A handle to an asset requested from an `AssetLoader`. Poll it with `IsReady()`.
+    // The copies of the handle share the same request.
+    // This changes its status only in `AssetLoader::Update()`, and must only be used on the main thread.
+    template <typename T>
+    class AssetRequest
+    {
+        friend AssetLoader;
+
+        struct Shared : detail::AssetRequestState
+        {
+            std::optional<T> value;
+        };
+        std::shared_ptr<Shared> shared;
+
+        explicit AssetRequest(std::shared_ptr<Shared> shared) : shared(std::move(shared)) {}
+
+        void ThrowIfNull() const
+        {
+            if (!shared)
+                throw std::logic_error("Attempt to use a null `Graphics::AssetRequest`.");
+        }
+
+      public:
+        constexpr AssetRequest() {}
+
+        [[nodiscard]] explicit operator bool() const {return bool(shared);}
+
+        [[nodiscard]] AssetStatus GetStatus() const {ThrowIfNull(); return shared->status;}
+        [[nodiscard]] bool IsReady() const {return GetStatus() == AssetStatus::ready;}
+        // True if ready, failed, or cancelled.
+        [[nodiscard]] bool IsDone() const {return GetStatus() != AssetStatus::pending;}
+
+        // Returns the asset. Doesn't block. Throws if it isn't ready yet, or rethrows the exception if the loading has failed.
+        [[nodiscard]] T &Get() const
+        {
+            ThrowIfNull();
+            switch (shared->status)
+            {
+              case AssetStatus::pending:
+                throw std::logic_error("Attempt to get an asset that isn't loaded yet.");
+              case AssetStatus::ready:
+                return *shared->value;
+              case AssetStatus::failed:
+                std::rethrow_exception(shared->exception);
+              case AssetStatus::cancelled:
+                throw std::logic_error("Attempt to get an asset whose loading was cancelled.");
+            }
+            throw std::logic_error("Invalid asset status.");
+        }
+
+        // Returns the asset if it's ready, or `fallback` if it's still pending. Rethrows the exception if the loading has failed.
+        [[nodiscard]] T &GetOr(T &fallback) const
+        {
+            if (GetStatus() == AssetStatus::pending)
+                return fallback;
+            return Get();
+        }
+
+        // Cancels the request if it isn't done yet. The request is skipped if no worker has started on it yet, otherwise its result is discarded.
+        void Cancel() const
+        {
+            ThrowIfNull();
+            if (shared->status != AssetStatus::pending)
+                return;
+            shared->cancelled = true;
+            shared->status = AssetStatus::cancelled;
+        }
+    };
+
+    // Loads assets in the background, to avoid stalling the frames, e.g. when streaming levels.
+    // The files are read and decoded on worker threads. The textures are then uploaded on the main thread in `Update()`,
+    //   all through one `Gpu::StagingUploader` and one copy pass.
+    // The requests with a higher priority are started first. The requests with the same priority are started in the order they were made.
+    //
+    // The asset names are paths relative to `Filesystem::GetResourceDir()`. If you pass an `AssetArchive`, the names are looked up in it first.
+    // Call `Update()` once per frame on the main thread. The requests only become ready there.
+    class AssetLoader
+    {
+      public:
+        struct Params
+        {
+            // If zero, uses the number of CPU cores.
+            int num_threads = 0;
+
+            // If not null, the assets are loaded from this archive when it has them. It must outlive the loader.
+            const AssetArchive *archive = nullptr;
+
+            // `Update()` stops finishing the requests after uploading this many bytes in one call. This avoids hitches when many textures finish at once.
+            // At least one request is always finished per call, regardless of the size.
+            std::size_t max_upload_bytes_per_update = 16 << 20;
+
+            // For the uploads. See `Gpu::StagingUploader::Params`.
+            Gpu::StagingUploader::Params uploader_params{};
+        };
+
+      private:
+        // Runs on the main thread in `Update()`. Returns the number of bytes uploaded to the GPU.
+        using MainThreadFunc = std::function<std::size_t(Gpu::Device &device, Gpu::StagingUploader &uploader)>;
+
+        struct Task
+        {
+            int priority = 0;
+            // This is used to preserve the order of the requests with the same priority.
+            std::uint64_t sequence = 0;
+
+            std::string name;
+            std::shared_ptr<detail::AssetRequestState> request;
+
+            // Runs on a worker thread, receives the file contents.
+            std::function<MainThreadFunc(blob data)> process;
+        };
+
+        // This is ordered by priority.
+        struct TaskLess
+        {
+            [[nodiscard]] bool operator()(const Task &a, const Task &b) const
+            {
+                if (a.priority != b.priority)
+                    return a.priority < b.priority;
+                return a.sequence > b.sequence;
+            }
+        };
+
+        struct Finished
+        {
+            std::shared_ptr<detail::AssetRequestState> request;
+            // Null if the request was cancelled or has failed.
+            MainThreadFunc func;
+            std::exception_ptr exception;
+        };
+
+        // This is shared with the worker threads. Stored by pointer to keep the loader movable.
+        struct Shared
+        {
+            const AssetArchive *archive = nullptr;
+
+            std::mutex mutex;
+            // A heap ordered by `TaskLess`.
+            std::vector<Task> queue;
+            // The tasks that finished on the worker threads, waiting for `Update()`.
+            std::vector<Finished> finished;
+        };
+
+        struct State
+        {
+            Params params;
+
+            std::unique_ptr<Shared> shared;
+            // This must be destroyed before `shared`, since the threads refer to it.
+            ThreadPool thread_pool;
+
+            // The rest is only used on the main thread.
+
+            std::uint64_t next_sequence = 0;
+            // The requests that weren't finished by `Update()` yet.
+            std::size_t num_pending = 0;
+
+            // The finished tasks that `Update()` didn't have time for.
+            std::deque<Finished> finished;
+
+            Gpu::StagingUploader uploader;
+        };
+        State state;
+
+        static void WorkerStep(Shared &shared);
+
+        void QueueTask(std::string name, int priority, std::shared_ptr<detail::AssetRequestState> request, std::function<MainThreadFunc(blob data)> process);
+
+      public:
+        AssetLoader() {}
+
+        explicit AssetLoader(const Params &params);
+
+        AssetLoader(AssetLoader &&other) noexcept
+            : state(std::move(other.state))
+        {
+            other.state = {};
+        }
+        AssetLoader &operator=(AssetLoader other) noexcept
+        {
+            std::swap(state, other.state);
+            return *this;
+        }
+
+        // Drops the requests that weren't started yet, and waits for the rest.
+        ~AssetLoader();
+
+        [[nodiscard]] explicit operator bool() const {return bool(state.shared);}
+
+        // Loads an asset and converts it with `decode`, which runs on a worker thread.
+        template <typename T>
+        [[nodiscard]] AssetRequest<T> Load(std::string name, std::function<T(blob data)> decode, int priority = 0)
+        {
+            auto shared = std::make_shared<typename AssetRequest<T>::Shared>();
+            QueueTask(std::move(name), priority, shared, [shared, decode = std::move(decode)](blob data) -> MainThreadFunc
+            {
+                // `std::function` needs copyable functors, so we wrap the value in `shared_ptr`.
+                auto value = std::make_shared<T>(decode(std::move(data)));
+                return [shared, value](Gpu::Device &, Gpu::StagingUploader &) -> std::size_t
+                {
+                    shared->value.emplace(std::move(*value));
+                    return 0;
+                };
+            });
+            return AssetRequest<T>(std::move(shared));
+        }
+
+        // Loads the raw bytes of an asset.
+        [[nodiscard]] AssetRequest<blob> LoadBytes(std::string name, int priority = 0);
+
+        // Loads and decodes an image.
+        [[nodiscard]] AssetRequest<Image> LoadImage(std::string name, int priority = 0);
+
+        // Loads and decodes an image on a worker thread, then creates a texture from it and uploads it in `Update()`.
+        // If the asset is a `Gpu::CompressedImage`, uploads its blocks and mipmaps as is. That throws if the GPU doesn't support its format.
+        [[nodiscard]] AssetRequest<Gpu::Texture> LoadTexture(std::string name, int priority = 0, Gpu::Texture::UsageFlags usage = Gpu::Texture::UsageFlags::sampler);
+
+        // The number of requests that weren't finished by `Update()` yet, including the cancelled ones.
+        [[nodiscard]] std::size_t NumPending() const {return state.num_pending;}
+
+        // Call this once per frame on the main thread. Finishes the requests that were loaded by the worker threads,
+        //   and submits a copy command buffer with the texture uploads, if any. Returns the number of requests that became ready or failed.
+        std::size_t Update(Gpu::Device &device);
+
+        // Blocks until all requests are finished. This is for the loading screens.
+        void WaitUntilIdle(Gpu::Device &device);
+    };
+}
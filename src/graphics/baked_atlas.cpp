@@ -0,0 +1,294 @@
+#include "baked_atlas.h"
+
+#include "command_line/parser.h"
+#include "gpu/copy_pass.h"
+#include "gpu/device.h"
+#include "gpu/staging_uploader.h"
+#include "utils/hash_func.h"
+#include "utils/image.h"
+#include "utils/terminal.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace em::Graphics
+{
+    namespace
+    {
+        struct Header
+        {
+            std::array<char, 4> magic = {'E', 'M', 'A', 'T'};
+            std::uint32_t version = BakedAtlas::format_version;
+            std::uint32_t source_hash = 0;
+            std::uint32_t num_pages = 0;
+            std::int32_t page_width = 0;
+            std::int32_t page_height = 0;
+            std::uint32_t num_regions = 0;
+            std::uint32_t names_size = 0;
+        };
+
+        struct RegionEntry
+        {
+            // In `names`.
+            std::uint32_t name_offset = 0;
+            std::uint32_t name_size = 0;
+
+            std::uint32_t page = 0;
+            std::int32_t x = 0;
+            std::int32_t y = 0;
+            std::int32_t w = 0;
+            std::int32_t h = 0;
+        };
+
+        // The pixels start at a multiple of this.
+        constexpr std::size_t pixels_alignment = 4;
+
+        [[nodiscard]] std::size_t AlignPixelsOffset(std::size_t offset)
+        {
+            return (offset + pixels_alignment - 1) / pixels_alignment * pixels_alignment;
+        }
+    }
+
+    BakedAtlas::BakedAtlas(std::string_view name, blob new_data)
+        : data(std::move(new_data))
+    {
+        auto Error = [&](std::string_view message)
+        {
+            return std::runtime_error(fmt::format("Invalid baked atlas `{}`: {}", name, message));
+        };
+
+        std::string_view bytes = data;
+
+        Header header;
+        if (bytes.size() < sizeof(Header))
+            throw Error("The file is too small.");
+        std::memcpy(&header, bytes.data(), sizeof(Header));
+        if (header.magic != Header{}.magic)
+            throw Error("Wrong file type.");
+        if (header.version != format_version)
+            throw Error(fmt::format("Wrong format version {}, expected {}.", header.version, format_version));
+        // Sanity check, to avoid overflows below. No GPU supports textures this large anyway.
+        if (header.page_width <= 0 || header.page_height <= 0 || header.page_width > 0x8000 || header.page_height > 0x8000)
+            throw Error("Invalid page size.");
+
+        // Everything below is validated by dividing the remaining size, rather than by multiplying the untrusted counts, so nothing can overflow.
+        const std::size_t entries_offset = sizeof(Header);
+        if ((bytes.size() - entries_offset) / sizeof(RegionEntry) < header.num_regions)
+            throw Error("The file is truncated.");
+        const std::size_t names_offset = entries_offset + std::size_t(header.num_regions) * sizeof(RegionEntry);
+        if (bytes.size() - names_offset < header.names_size)
+            throw Error("The file is truncated.");
+        const std::string_view names = bytes.substr(names_offset, header.names_size);
+
+        source_hash = header.source_hash;
+        page_size = ivec2(header.page_width, header.page_height);
+        num_pages = header.num_pages;
+
+        pixels_offset = AlignPixelsOffset(names_offset + header.names_size);
+        const std::size_t page_bytes = std::size_t(page_size.x) * std::size_t(page_size.y) * sizeof(u8vec4);
+        if (pixels_offset > bytes.size() || (bytes.size() - pixels_offset) % page_bytes != 0 || (bytes.size() - pixels_offset) / page_bytes != num_pages)
+            throw Error("The file size doesn't match the number of pages.");
+
+        regions.reserve(header.num_regions);
+        for (std::size_t i = 0; i < header.num_regions; i++)
+        {
+            RegionEntry entry;
+            std::memcpy(&entry, bytes.data() + entries_offset + i * sizeof(RegionEntry), sizeof(RegionEntry));
+
+            if (std::size_t(entry.name_offset) + entry.name_size > names.size())
+                throw Error("A region name is out of bounds.");
+            if (entry.page >= num_pages)
+                throw Error("A region page index is out of bounds.");
+            // Those are 32-bit, so doing this in 64 bits can't overflow.
+            if (entry.x < 0 || entry.y < 0 || entry.w < 0 || entry.h < 0 || std::int64_t(entry.x) + entry.w > page_size.x || std::int64_t(entry.y) + entry.h > page_size.y)
+                throw Error("A region rectangle is out of bounds.");
+
+            std::string_view region_name = names.substr(entry.name_offset, entry.name_size);
+            if (!regions.try_emplace(std::string(region_name), TextureAtlas::Region{.page = entry.page, .pos = ivec2(entry.x, entry.y), .size = ivec2(entry.w, entry.h)}).second)
+                throw Error(fmt::format("Duplicate region name `{}`.", region_name));
+        }
+    }
+
+    std::string BakedAtlas::Bake(std::span<const Source> sources, const TextureAtlas::Params &params, std::uint32_t source_hash)
+    {
+        std::vector<std::string> paths;
+        paths.reserve(sources.size());
+        for (const Source &source : sources)
+            paths.push_back(source.path);
+
+        // Baking can involve thousands of images, so decode them on all cores.
+        std::vector<Image> images = LoadImagesInParallel(paths);
+
+        std::vector<const Image *> image_ptrs;
+        image_ptrs.reserve(images.size());
+        for (const Image &image : images)
+            image_ptrs.push_back(&image);
+
+        TextureAtlas atlas(params);
+        std::vector<TextureAtlas::Region> atlas_regions = atlas.AddImages(image_ptrs);
+
+        std::string names;
+        std::vector<RegionEntry> entries;
+        entries.reserve(sources.size());
+        for (std::size_t i = 0; i < sources.size(); i++)
+        {
+            const TextureAtlas::Region &region = atlas_regions[i];
+            entries.push_back({
+                .name_offset = std::uint32_t(names.size()),
+                .name_size = std::uint32_t(sources[i].name.size()),
+                .page = std::uint32_t(region.page),
+                .x = region.pos.x,
+                .y = region.pos.y,
+                .w = region.size.x,
+                .h = region.size.y,
+            });
+            names += sources[i].name;
+        }
+
+        const Header header{
+            .source_hash = source_hash,
+            .num_pages = std::uint32_t(atlas.NumPages()),
+            .page_width = params.page_size.x,
+            .page_height = params.page_size.y,
+            .num_regions = std::uint32_t(entries.size()),
+            .names_size = std::uint32_t(names.size()),
+        };
+
+        std::string ret;
+        auto Append = [&](const void *bytes, std::size_t size)
+        {
+            ret.append(static_cast<const char *>(bytes), size);
+        };
+
+        Append(&header, sizeof(header));
+        Append(entries.data(), entries.size() * sizeof(RegionEntry));
+        ret += names;
+        ret.resize(AlignPixelsOffset(ret.size()));
+        for (std::size_t i = 0; i < atlas.NumPages(); i++)
+        {
+            std::span<const u8vec4> pixels = atlas.GetPagePixels(i).as_flat_array();
+            Append(pixels.data(), pixels.size_bytes());
+        }
+
+        return ret;
+    }
+
+    std::uint32_t BakedAtlas::HashSources(std::span<const Source> sources, const TextureAtlas::Params &params)
+    {
+        const std::array<std::int32_t, 5> params_array = {std::int32_t(format_version), params.page_size.x, params.page_size.y, params.padding, params.extrusion};
+        std::uint32_t hash = Hash32(params_array);
+
+        for (const Source &source : sources)
+        {
+            hash = Hash32(source.name, hash);
+            hash = Hash32(std::string_view(Filesystem::FileContents(source.path)), hash);
+        }
+
+        return hash;
+    }
+
+    const TextureAtlas::Region &BakedAtlas::GetRegion(std::string_view name) const
+    {
+        if (auto region = GetRegionOpt(name))
+            return *region;
+        throw std::runtime_error(fmt::format("No region named `{}` in the baked atlas.", name));
+    }
+
+    const TextureAtlas::Region *BakedAtlas::GetRegionOpt(std::string_view name) const
+    {
+        auto iter = regions.find(name);
+        return iter != regions.end() ? &iter->second : nullptr;
+    }
+
+    void BakedAtlas::Upload(Gpu::Device &device, Gpu::CopyPass &copy_pass)
+    {
+        // Put all pages into a single transfer buffer, with some extra space for the alignment padding.
+        const std::size_t page_bytes = std::size_t(page_size.x) * std::size_t(page_size.y) * sizeof(u8vec4);
+        Gpu::StagingUploader uploader({.chunk_size = std::uint32_t(std::max<std::size_t>(num_pages * (page_bytes + Gpu::StagingUploader::texture_alignment), 1))});
+        Upload(device, uploader);
+        uploader.Flush(copy_pass);
+    }
+
+    void BakedAtlas::Upload(Gpu::Device &device, Gpu::StagingUploader &uploader)
+    {
+        if (!textures.empty())
+            throw std::logic_error("`BakedAtlas::Upload()` was called twice.");
+
+        const std::size_t page_bytes = std::size_t(page_size.x) * std::size_t(page_size.y) * sizeof(u8vec4);
+
+        textures.reserve(num_pages);
+        for (std::size_t i = 0; i < num_pages; i++)
+        {
+            Gpu::Texture &texture = textures.emplace_back(device, Gpu::Texture::Params{.size = page_size.to_vec3(1)});
+
+            // The pages are stored in the same format as the textures, so this is just a copy.
+            uploader.UploadToTexture(device, std::span<const unsigned char>(data).subspan(pixels_offset + i * page_bytes, page_bytes), texture);
+        }
+
+        // We no longer need the pixels.
+        data = {};
+    }
+
+    BakedAtlas AtlasBaker::Load(std::string_view name, std::span<const BakedAtlas::Source> sources, const TextureAtlas::Params &params) const
+    {
+        std::string path = fmt::format("{}/{}.atlas", dir, name);
+
+        if (!bake_when_loading)
+            return BakedAtlas(path, Filesystem::FileContents(path));
+
+        const std::uint32_t hash = BakedAtlas::HashSources(sources, params);
+
+        bool file_was_loaded = false;
+        Filesystem::FileContents file(path, &file_was_loaded);
+        if (file_was_loaded)
+        {
+            try
+            {
+                BakedAtlas ret(path, std::move(file));
+                if (ret.SourceHash() == hash)
+                    return ret;
+            }
+            catch (std::exception &)
+            {
+                // The file is broken or uses an older format, just rebake it.
+            }
+        }
+
+        Terminal::DefaultToConsole(stderr);
+        fmt::print(stderr, "### Baking atlas `{}` ###\n", name);
+
+        std::string baked = BakedAtlas::Bake(sources, params, hash);
+
+        Filesystem::CreateDirectories(dir);
+        Filesystem::File output(path, "wb");
+        if (std::fwrite(baked.data(), baked.size(), 1, output.Handle()) != 1)
+            throw std::runtime_error(fmt::format("Unable to write the baked atlas to `{}`.", path));
+
+        return BakedAtlas(path, zblob(zblob::Owning{}, std::move(baked)));
+    }
+
+    void AtlasBaker::ProvidedCommandLineFlags(CommandLine::Parser &parser)
+    {
+        parser.AddFlag<std::string>(
+            "-A,--bake-atlases",
+            {},
+            "dir",
+            "Load baked texture atlases from `dir` instead of their normal location. Rebake any missing or outdated ones.",
+            [this](std::string new_dir)
+            {
+                dir = std::move(new_dir);
+                bake_when_loading = true;
+            },
+            [this]
+            {
+                // Create the directory right away, to fail early if it's not writable, rather than after baking the first atlas.
+                if (bake_when_loading && !Filesystem::CreateDirectories(dir))
+                    throw std::runtime_error(fmt::format("Unable to create the baked atlas directory `{}`.", dir));
+            }
+        );
+    }
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "em/zstring_view.h"
+#include "gpu/texture.h"
+#include "graphics/texture_atlas.h"
+#include "utils/blob.h"
+#include "utils/filesystem.h"
+
+#include <fmt/format.h>
+#include <gtl/phmap.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace em::CommandLine
+{
+    class Parser;
+}
+
+namespace em::Gpu
+{
+    class CopyPass;
+    class StagingUploader;
+    class Device;
+}
+
+namespace em::Graphics
+{
+    // A texture atlas that was packed ahead of time and saved to a file, see `AtlasBaker` for how to create those.
+    // Loading this doesn't decode any images or pack anything, it's just a single file read and a direct upload of the pages.
+    //
+    // The file format (all integers are in the native byte order, since those files are generated on the same platform):
+    //     Header
+    //     RegionEntry[num_regions]
+    //     char names[names_size] // The region names, not null-terminated.
+    //     (padding to 4 bytes)
+    //     u8vec4 pixels[num_pages][page_size.y][page_size.x]
+    class BakedAtlas
+    {
+      public:
+        // A source image for baking.
+        struct Source
+        {
+            // The name for `GetRegion()`.
+            std::string name;
+            // The image file path.
+            std::string path;
+        };
+
+        // Increment this when changing the format.
+        static constexpr std::uint32_t format_version = 1;
+
+      private:
+        blob data;
+        std::size_t pixels_offset = 0;
+
+        std::uint32_t source_hash = 0;
+        ivec2 page_size;
+        std::size_t num_pages = 0;
+
+        gtl::flat_hash_map<std::string, TextureAtlas::Region> regions;
+        std::vector<Gpu::Texture> textures;
+
+      public:
+        BakedAtlas() {}
+
+        // Parses the file contents. `name` is only used for error messages. Throws if the data is invalid.
+        BakedAtlas(std::string_view name, blob data);
+
+        // Packs the images into a new atlas and serializes it. `source_hash` should be the result of `HashSources()`.
+        [[nodiscard]] static std::string Bake(std::span<const Source> sources, const TextureAtlas::Params &params, std::uint32_t source_hash);
+
+        // Hashes the names and the contents of the source images, and the atlas parameters. This changes when anything affecting the result changes.
+        [[nodiscard]] static std::uint32_t HashSources(std::span<const Source> sources, const TextureAtlas::Params &params);
+
+        // The hash of the sources this was baked from.
+        [[nodiscard]] std::uint32_t SourceHash() const {return source_hash;}
+
+        [[nodiscard]] std::size_t NumPages() const {return num_pages;}
+
+        // Throws if there's no such region.
+        [[nodiscard]] const TextureAtlas::Region &GetRegion(std::string_view name) const;
+
+        // Returns null if there's no such region.
+        [[nodiscard]] const TextureAtlas::Region *GetRegionOpt(std::string_view name) const;
+
+        // The texture of a page. This is null until `Upload()`.
+        [[nodiscard]] Gpu::Texture &GetTexture(std::size_t page) {return textures.at(page);}
+
+        // Creates the textures and uploads the pages. Then frees the file contents, so this can only be called once.
+        void Upload(Gpu::Device &device, Gpu::CopyPass &copy_pass);
+        // Same, but queues the uploads into `uploader`, to be batched with other uploads.
+        void Upload(Gpu::Device &device, Gpu::StagingUploader &uploader);
+    };
+
+    // Loads baked atlases, and optionally bakes them.
+    class AtlasBaker
+    {
+      public:
+        // The directory where we look for baked atlases, and place the new ones if baking is enabled.
+        std::string dir = fmt::format("{}{}", Filesystem::GetResourceDir(), "assets/atlases");
+
+        // Set to true to rebake the missing and outdated atlases in `Load()`.
+        // When this is false, the source images aren't touched at all, and don't even need to exist.
+        bool bake_when_loading = false;
+
+        // Loads `{dir}/{name}.atlas`.
+        // Unlike `ShaderManager`, the hash isn't a part of the file name, since we don't want to read the sources to compute it when not baking.
+        //   Instead, the hash is stored in the file.
+        [[nodiscard]] BakedAtlas Load(std::string_view name, std::span<const BakedAtlas::Source> sources, const TextureAtlas::Params &params) const;
+
+        void ProvidedCommandLineFlags(CommandLine::Parser &parser);
+    };
+}
@@ -0,0 +1,183 @@
+#include "draw_queue.h"
+
+#include "em/meta/overload.h"
+#include "gpu/command_buffer.h"
+#include "gpu/copy_pass.h"
+#include "gpu/device.h"
+#include "gpu/pipeline.h"
+#include "gpu/render_pass.h"
+#include "gpu/texture.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+namespace em::Graphics
+{
+    DrawQueue::DrawQueue(Gpu::Device &device, const Params &params)
+    {
+        if (params.vertex_size == 0)
+            throw std::logic_error("The vertex size of a `DrawQueue` can't be zero.");
+
+        state.params = params;
+        state.buffer = StreamingBuffer(device, std::uint32_t(params.num_vertices * params.vertex_size));
+    }
+
+    DrawQueue::PipelineId DrawQueue::AddPipeline(Gpu::Pipeline &pipeline)
+    {
+        if (state.pipelines.size() > std::uint16_t(-1))
+            throw std::logic_error("Too many pipelines in a `DrawQueue`.");
+        state.pipelines.push_back(&pipeline);
+        return PipelineId(state.pipelines.size() - 1);
+    }
+
+    DrawQueue::PipelineId DrawQueue::AddPipeline(Gpu::DynamicPipeline &pipeline)
+    {
+        if (state.pipelines.size() > std::uint16_t(-1))
+            throw std::logic_error("Too many pipelines in a `DrawQueue`.");
+        state.pipelines.push_back(&pipeline);
+        return PipelineId(state.pipelines.size() - 1);
+    }
+
+    DrawQueue::TextureId DrawQueue::AddTexture(Gpu::Shader::TextureAndSampler texture)
+    {
+        if (state.textures.size() > std::uint16_t(-1))
+            throw std::logic_error("Too many textures in a `DrawQueue`.");
+        state.textures.push_back(texture);
+        return TextureId(state.textures.size() - 1);
+    }
+
+    mut_byte_view DrawQueue::AddDrawBytes(std::uint64_t key, std::size_t num_vertices)
+    {
+        if (!*this)
+            throw std::logic_error("Attempt to use a null `DrawQueue`.");
+
+        // Validate early, to get the error at the right place.
+        std::size_t pipeline = (key >> 32) & 0xffff;
+        std::size_t texture = (key >> 16) & 0xffff;
+        if (pipeline >= state.pipelines.size() || texture >= state.textures.size())
+            throw std::logic_error(fmt::format("Pipeline #{} or texture #{} is not registered in this `DrawQueue`.", pipeline, texture));
+
+        std::size_t first_vertex = state.vertices.size() / state.params.vertex_size;
+        state.vertices.resize(state.vertices.size() + num_vertices * state.params.vertex_size);
+
+        // Extend the previous draw if the key is the same. This makes the sorting cheaper, but doesn't affect the result.
+        if (!state.commands.empty() && state.commands.back().key == key)
+            state.commands.back().num_vertices += std::uint32_t(num_vertices);
+        else
+            state.commands.push_back({.key = key, .first_vertex = std::uint32_t(first_vertex), .num_vertices = std::uint32_t(num_vertices)});
+
+        return std::span(state.vertices).subspan(first_vertex * state.params.vertex_size, num_vertices * state.params.vertex_size);
+    }
+
+    void DrawQueue::Flush(Gpu::Device &device, Gpu::CommandBuffer &render_cmdbuf, Gpu::RenderPass &render_pass, Gpu::CopyPass &copy_pass)
+    {
+        if (!*this)
+            throw std::logic_error("Attempt to use a null `DrawQueue`.");
+
+        if (state.commands.empty())
+            return;
+
+        const std::uint32_t vertex_size = state.params.vertex_size;
+        const std::size_t num_commands = state.commands.size();
+
+        { // Sort the commands by key.
+            // This is an LSD radix sort, one byte at a time. It's stable, which we need to keep the submission order within the same key.
+            // Only the bytes that actually differ between the keys are sorted by, which is usually only a few of them.
+            std::uint64_t bits_and = std::uint64_t(-1);
+            std::uint64_t bits_or = 0;
+            for (const Command &command : state.commands)
+            {
+                bits_and &= command.key;
+                bits_or |= command.key;
+            }
+            const std::uint64_t varying_bits = bits_and ^ bits_or;
+
+            state.order.resize(num_commands);
+            state.order_scratch.resize(num_commands);
+            std::iota(state.order.begin(), state.order.end(), std::uint32_t(0));
+
+            for (int shift = 0; shift < 64; shift += 8)
+            {
+                if (((varying_bits >> shift) & 0xff) == 0)
+                    continue;
+
+                // The first element is always zero, the rest are the counts, and then the starting positions after the prefix sum.
+                std::array<std::uint32_t, 257> offsets{};
+                for (std::uint32_t i : state.order)
+                    offsets[((state.commands[i].key >> shift) & 0xff) + 1]++;
+                std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+                for (std::uint32_t i : state.order)
+                    state.order_scratch[offsets[(state.commands[i].key >> shift) & 0xff]++] = i;
+
+                std::swap(state.order, state.order_scratch);
+            }
+        }
+
+        { // Copy the vertices in the sorted order.
+            state.buffer.BeginFrame(device);
+            char *out = state.buffer.Allocate(std::uint32_t(state.vertices.size())).bytes.data();
+
+            for (std::uint32_t i : state.order)
+            {
+                const Command &command = state.commands[i];
+                std::size_t num_bytes = std::size_t(command.num_vertices) * vertex_size;
+                std::memcpy(out, state.vertices.data() + std::size_t(command.first_vertex) * vertex_size, num_bytes);
+                out += num_bytes;
+            }
+
+            state.buffer.FinishFrame(copy_pass);
+        }
+
+        // Must bind this every time, since the upload cycles the buffer.
+        render_pass.BindVertexBuffers({{
+            {.buffer = &state.buffer.GetBuffer()},
+        }});
+
+        // Now draw the runs of equal keys, since they're now contiguous in the buffer.
+        std::size_t cur_pipeline = std::size_t(-1);
+        std::size_t cur_texture = std::size_t(-1);
+        std::uint32_t first_vertex = 0;
+
+        for (std::size_t i = 0; i < num_commands;)
+        {
+            const std::uint64_t key = state.commands[state.order[i]].key;
+
+            std::uint32_t num_vertices = 0;
+            for (; i < num_commands && state.commands[state.order[i]].key == key; i++)
+                num_vertices += state.commands[state.order[i]].num_vertices;
+
+            std::size_t pipeline = (key >> 32) & 0xffff;
+            if (pipeline != cur_pipeline)
+            {
+                render_pass.BindPipeline(std::visit(Meta::Overload{
+                    [](Gpu::Pipeline *p) -> Gpu::Pipeline & {return *p;},
+                    [](Gpu::DynamicPipeline *p) -> Gpu::Pipeline & {return p->GetPipeline();},
+                }, state.pipelines[pipeline]));
+                cur_pipeline = pipeline;
+            }
+
+            std::size_t texture = (key >> 16) & 0xffff;
+            if (texture != cur_texture)
+            {
+                const Gpu::Shader::TextureAndSampler &tex = state.textures[texture];
+                Gpu::Shader::BindTextures(render_pass, std::span(&tex, 1));
+                if (state.params.texture_size_uniform_slot && tex.texture)
+                    Gpu::Shader::SetUniform(render_cmdbuf, Gpu::Shader::Stage::fragment, *state.params.texture_size_uniform_slot, tex.texture->GetSize().to_vec2().to<float>());
+                cur_texture = texture;
+            }
+
+            render_pass.DrawPrimitives(num_vertices, first_vertex);
+            first_vertex += num_vertices;
+        }
+
+        state.commands.clear();
+        state.vertices.clear();
+    }
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "em/meta/reset_on_move.h"
+#include "gpu/shader.h"
+#include "graphics/streaming_buffer.h"
+#include "utils/byte_view.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <variant>
+#include <vector>
+
+namespace em::Gpu
+{
+    class CommandBuffer;
+    class CopyPass;
+    class Device;
+    class DynamicPipeline;
+    class Pipeline;
+    class RenderPass;
+}
+
+namespace em::Graphics
+{
+    // Records draws with arbitrary pipelines and textures during a frame, then sorts them by state and draws with as few state changes as possible.
+    // Each draw has a 64-bit sort key (see `MakeKey()`). On `Flush()` the draws are sorted by it, the vertices are copied in that order
+    //   into one GPU buffer, and each run of draws with the same key becomes a single draw call.
+    // Draws with equal keys keep their relative order, but draws with different keys in the same layer can be reordered,
+    //   so use different layers for things that must be drawn on top of each other.
+    // There's no separate blend mode in the key, since SDL has blending as a part of the pipeline state. Use one pipeline per blend mode.
+    class DrawQueue
+    {
+      public:
+        struct Params
+        {
+            // The size of one vertex. All pipelines used with this queue must use vertices of this size.
+            std::uint32_t vertex_size = 0;
+
+            // The initial capacity of the vertex storage. It grows automatically (see `StreamingBuffer`).
+            std::size_t num_vertices = 4096;
+
+            // If set, when binding a texture, its size is also uploaded to this fragment shader uniform slot as `vec2`.
+            // This is what `Renderer2d`'s shader expects.
+            std::optional<std::uint32_t> texture_size_uniform_slot;
+        };
+
+        // Those are indices in the lists of the registered pipelines and textures.
+        using PipelineId = std::uint16_t;
+        using TextureId = std::uint16_t;
+
+        // Sorting by layer first, then by pipeline, then by texture. Since switching pipelines is usually more expensive than switching textures.
+        [[nodiscard]] static constexpr std::uint64_t MakeKey(std::uint16_t layer, PipelineId pipeline, TextureId texture)
+        {
+            return std::uint64_t(layer) << 48 | std::uint64_t(pipeline) << 32 | std::uint64_t(texture) << 16;
+        }
+
+      private:
+        struct Command
+        {
+            std::uint64_t key = 0;
+
+            // In the CPU-side vertex storage.
+            std::uint32_t first_vertex = 0;
+            std::uint32_t num_vertices = 0;
+        };
+
+        struct State
+        {
+            Params params;
+
+            // The `DynamicPipeline`s are resolved in `Flush()`, since their current pipeline can change (or be destroyed) between frames.
+            std::vector<std::variant<Gpu::Pipeline *, Gpu::DynamicPipeline *>> pipelines;
+            std::vector<Gpu::Shader::TextureAndSampler> textures;
+
+            // The draws of the current frame, in submission order.
+            std::vector<Command> commands;
+            // The vertices of `commands`, in submission order.
+            std::vector<char> vertices;
+
+            // Scratch space for sorting.
+            std::vector<std::uint32_t> order, order_scratch;
+
+            // The vertices are copied here in the sorted order.
+            StreamingBuffer buffer;
+
+            // Need this to make Clang happy in `ResetMovedFromStruct<...>` below.
+            constexpr State() {}
+        };
+        Meta::ResetMovedFromStruct<State> state;
+
+      public:
+        constexpr DrawQueue() {}
+
+        DrawQueue(Gpu::Device &device, const Params &params);
+
+        DrawQueue(DrawQueue &&) = default;
+        DrawQueue &operator=(DrawQueue &&) = default;
+
+        [[nodiscard]] explicit operator bool() const {return bool(state.buffer);}
+
+        // Registers a pipeline or a texture, and returns its id for `MakeKey()`. The object must stay alive while it's registered.
+        // Those persist across frames. The ids are assigned sequentially, so the registration order affects the sorting order.
+        [[nodiscard]] PipelineId AddPipeline(Gpu::Pipeline &pipeline);
+        // For a `DynamicPipeline`, the pipeline for its current format is looked up on every `Flush()`.
+        [[nodiscard]] PipelineId AddPipeline(Gpu::DynamicPipeline &pipeline);
+        [[nodiscard]] TextureId AddTexture(Gpu::Shader::TextureAndSampler texture);
+
+        // How many draws were recorded in this frame so far.
+        [[nodiscard]] std::size_t NumQueuedDraws() const {return state.commands.size();}
+
+        // Records a draw, and returns the memory for its vertices to fill. The memory is valid until the next `AddDraw...()` or `Flush()`.
+        [[nodiscard]] mut_byte_view AddDrawBytes(std::uint64_t key, std::size_t num_vertices);
+
+        // A typed wrapper for `AddDrawBytes()`.
+        template <mut_byte_view_reinterpretable_as_range_of T>
+        [[nodiscard]] std::span<T> AddDraw(std::uint64_t key, std::size_t num_vertices)
+        {
+            assert(sizeof(T) == state.params.vertex_size);
+            return AddDrawBytes(key, num_vertices).AsRangeOf<T>();
+        }
+
+        // Sorts and draws everything recorded so far, and clears the queue.
+        // You must set the uniforms other than the texture size yourself beforehand.
+        // The requirements for the passes are the same as for `Renderer2d`: submit `copy_pass`, then `render_pass`, in this order.
+        // The `DynamicPipeline`s must already have their output format requested for this frame.
+        void Flush(Gpu::Device &device, Gpu::CommandBuffer &render_cmdbuf, Gpu::RenderPass &render_pass, Gpu::CopyPass &copy_pass);
+    };
+}
@@ -0,0 +1,175 @@
+#include "multi_draw_batch.h"
+
+#include "gpu/copy_pass.h"
+#include "gpu/device.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace em::Graphics
+{
+    namespace
+    {
+        [[nodiscard]] std::uint32_t IndexSizeInBytes(Gpu::RenderPass::IndexSize index_size)
+        {
+            switch (index_size)
+            {
+              case Gpu::RenderPass::IndexSize::_16:
+                return 2;
+              case Gpu::RenderPass::IndexSize::_32:
+                return 4;
+            }
+            throw std::logic_error("Invalid index size.");
+        }
+
+        // Converts a byte offset in a buffer arena to an element index. Throws if it's not aligned.
+        [[nodiscard]] std::uint32_t OffsetToElemIndex(std::uint32_t byte_offset, std::uint32_t elem_size)
+        {
+            if (elem_size == 0 || byte_offset % elem_size != 0)
+                throw std::logic_error(fmt::format("The buffer arena range offset {} isn't a multiple of the element size {}. Allocate it with the element size as the alignment.", byte_offset, elem_size));
+            return byte_offset / elem_size;
+        }
+    }
+
+    MultiDrawBatch::Group &MultiDrawBatch::FindOrAddGroup(Gpu::Buffer &vertex_buffer, Gpu::Buffer *index_buffer, Gpu::RenderPass::IndexSize index_size)
+    {
+        if (!*this)
+            throw std::logic_error("Attempt to use a null `MultiDrawBatch`.");
+        if (!state.indirect_buffer.IsInFrame() || state.finished)
+            throw std::logic_error("Draws can only be added to a `MultiDrawBatch` between `BeginFrame()` and `FinishFrame()`.");
+
+        // Search backwards, since consecutive draws often use the same buffers.
+        auto iter = std::find_if(state.groups.rbegin(), state.groups.rend(), [&](const Group &group)
+        {
+            return group.vertex_buffer == &vertex_buffer && group.index_buffer == index_buffer && (!index_buffer || group.index_size == index_size);
+        });
+        if (iter != state.groups.rend())
+            return *iter;
+
+        Group &group = state.groups.emplace_back();
+        group.vertex_buffer = &vertex_buffer;
+        group.index_buffer = index_buffer;
+        group.index_size = index_size;
+        return group;
+    }
+
+    MultiDrawBatch::MultiDrawBatch(Gpu::Device &device, std::uint32_t initial_capacity)
+    {
+        if (initial_capacity == 0)
+            throw std::logic_error("The initial capacity of a `MultiDrawBatch` can't be zero.");
+
+        // Size this for indexed draws, since those are larger.
+        state.indirect_buffer = StreamingBuffer(device, std::uint32_t(initial_capacity * sizeof(Gpu::RenderPass::IndirectIndexedDraw)), Gpu::Buffer::Usage::indirect);
+    }
+
+    void MultiDrawBatch::BeginFrame(Gpu::Device &device)
+    {
+        state.indirect_buffer.BeginFrame(device); // This throws if we're null.
+        state.groups.clear();
+        state.finished = false;
+    }
+
+    void MultiDrawBatch::AddDraw(Gpu::Buffer &vertex_buffer, const Gpu::RenderPass::IndirectDraw &args)
+    {
+        if (args.num_vertices == 0 || args.num_instances == 0)
+            return;
+        FindOrAddGroup(vertex_buffer, nullptr, {}).draws.push_back(args);
+    }
+
+    void MultiDrawBatch::AddIndexedDraw(Gpu::Buffer &vertex_buffer, Gpu::Buffer &index_buffer, Gpu::RenderPass::IndexSize index_size, const Gpu::RenderPass::IndirectIndexedDraw &args)
+    {
+        if (args.num_indices == 0 || args.num_instances == 0)
+            return;
+        FindOrAddGroup(vertex_buffer, &index_buffer, index_size).indexed_draws.push_back(args);
+    }
+
+    void MultiDrawBatch::AddDraw(const Gpu::BufferArena::Range &vertices, std::uint32_t vertex_size, std::uint32_t num_instances, std::uint32_t first_instance)
+    {
+        if (!vertices)
+            throw std::logic_error("Attempt to draw a null buffer arena range.");
+
+        AddDraw(*vertices.buffer, {
+            .num_vertices = vertices.size / vertex_size,
+            .num_instances = num_instances,
+            .first_vertex = OffsetToElemIndex(vertices.byte_offset, vertex_size),
+            .first_instance = first_instance,
+        });
+    }
+
+    void MultiDrawBatch::AddIndexedDraw(const Gpu::BufferArena::Range &vertices, std::uint32_t vertex_size, const Gpu::BufferArena::Range &indices, Gpu::RenderPass::IndexSize index_size, std::uint32_t num_instances, std::uint32_t first_instance)
+    {
+        if (!vertices || !indices)
+            throw std::logic_error("Attempt to draw a null buffer arena range.");
+
+        const std::uint32_t index_bytes = IndexSizeInBytes(index_size);
+
+        AddIndexedDraw(*vertices.buffer, *indices.buffer, index_size, {
+            .num_indices = indices.size / index_bytes,
+            .num_instances = num_instances,
+            .first_index = OffsetToElemIndex(indices.byte_offset, index_bytes),
+            .vertex_offset = std::int32_t(OffsetToElemIndex(vertices.byte_offset, vertex_size)),
+            .first_instance = first_instance,
+        });
+    }
+
+    std::size_t MultiDrawBatch::NumDraws() const
+    {
+        std::size_t ret = 0;
+        for (const Group &group : state.groups)
+            ret += group.draws.size() + group.indexed_draws.size();
+        return ret;
+    }
+
+    std::uint32_t MultiDrawBatch::FinishFrame(Gpu::CopyPass &pass)
+    {
+        if (!state.indirect_buffer.IsInFrame() || state.finished)
+            throw std::logic_error("`MultiDrawBatch::FinishFrame()` was called without `BeginFrame()`.");
+
+        // Each group lands in one contiguous piece of the indirect buffer.
+        for (Group &group : state.groups)
+        {
+            std::uint32_t first_elem = 0;
+            if (group.index_buffer)
+            {
+                auto dest = state.indirect_buffer.AllocateElems<Gpu::RenderPass::IndirectIndexedDraw>(group.indexed_draws.size(), &first_elem);
+                std::copy(group.indexed_draws.begin(), group.indexed_draws.end(), dest.begin());
+                group.byte_offset = std::uint32_t(first_elem * sizeof(Gpu::RenderPass::IndirectIndexedDraw));
+            }
+            else
+            {
+                auto dest = state.indirect_buffer.AllocateElems<Gpu::RenderPass::IndirectDraw>(group.draws.size(), &first_elem);
+                std::copy(group.draws.begin(), group.draws.end(), dest.begin());
+                group.byte_offset = std::uint32_t(first_elem * sizeof(Gpu::RenderPass::IndirectDraw));
+            }
+        }
+
+        state.finished = true;
+        return state.indirect_buffer.FinishFrame(pass);
+    }
+
+    void MultiDrawBatch::Draw(Gpu::RenderPass &pass, std::uint32_t vertex_buffer_slot)
+    {
+        if (!state.finished)
+            throw std::logic_error("`MultiDrawBatch::Draw()` must be called after `FinishFrame()`.");
+
+        Gpu::Buffer &indirect_buffer = state.indirect_buffer.GetBuffer();
+
+        for (Group &group : state.groups)
+        {
+            Gpu::RenderPass::VertexBuffer vertex_buffer{.buffer = group.vertex_buffer};
+            pass.BindVertexBuffers({&vertex_buffer, 1}, vertex_buffer_slot);
+
+            if (group.index_buffer)
+            {
+                pass.BindIndexBuffer({.buffer = group.index_buffer, .index_size = group.index_size});
+                pass.DrawIndexedPrimitivesIndirect(indirect_buffer, group.byte_offset, std::uint32_t(group.indexed_draws.size()));
+            }
+            else
+            {
+                pass.DrawPrimitivesIndirect(indirect_buffer, group.byte_offset, std::uint32_t(group.draws.size()));
+            }
+        }
+    }
+}
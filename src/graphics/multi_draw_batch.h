@@ -0,0 +1,104 @@
+#pragma once
+
+#include "gpu/buffer.h"
+#include "gpu/buffer_arena.h"
+#include "gpu/render_pass.h"
+#include "graphics/streaming_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace em::Gpu
+{
+    class CopyPass;
+    class Device;
+}
+
+namespace em::Graphics
+{
+    // Draws many distinct meshes with a few indirect draw calls, instead of one draw call per mesh.
+    // The draw arguments are written to an indirect buffer, and then all draws that share the same vertex (and index) buffers are issued with a single
+    //   `RenderPass::DrawPrimitivesIndirect()` or `DrawIndexedPrimitivesIndirect()` call. This works best with meshes from a `Gpu::BufferArena`,
+    //   where thousands of meshes share a few buffers.
+    //
+    // Every frame: call `BeginFrame()`, add the draws, call `FinishFrame()` in a copy pass, then `Draw()` in a render pass after binding the pipeline.
+    // All draws use the same pipeline and the same bindings other than the vertex and index buffers. Use several batches if you need more than that.
+    // The draws are NOT performed in the order they're added: they're grouped by the buffers first.
+    class MultiDrawBatch
+    {
+        struct Group
+        {
+            Gpu::Buffer *vertex_buffer = nullptr;
+
+            // Those are only used for indexed draws.
+            Gpu::Buffer *index_buffer = nullptr;
+            Gpu::RenderPass::IndexSize index_size{};
+
+            // Only one of those is used, depending on whether `index_buffer` is null.
+            std::vector<Gpu::RenderPass::IndirectDraw> draws;
+            std::vector<Gpu::RenderPass::IndirectIndexedDraw> indexed_draws;
+
+            // Where the draws landed in the indirect buffer. Set by `FinishFrame()`.
+            std::uint32_t byte_offset = 0;
+        };
+
+        struct State
+        {
+            StreamingBuffer indirect_buffer;
+
+            // We expect only a few of those (one per buffer arena page), so we just search them linearly.
+            std::vector<Group> groups;
+
+            bool finished = false;
+        };
+        State state;
+
+        [[nodiscard]] Group &FindOrAddGroup(Gpu::Buffer &vertex_buffer, Gpu::Buffer *index_buffer, Gpu::RenderPass::IndexSize index_size);
+
+      public:
+        MultiDrawBatch() {}
+
+        // `initial_capacity` is in draws. If a frame needs more, the storage grows automatically (see `StreamingBuffer`).
+        explicit MultiDrawBatch(Gpu::Device &device, std::uint32_t initial_capacity = 256);
+
+        MultiDrawBatch(MultiDrawBatch &&other) noexcept
+            : state(std::move(other.state))
+        {
+            other.state = {};
+        }
+        MultiDrawBatch &operator=(MultiDrawBatch other) noexcept
+        {
+            std::swap(state, other.state);
+            return *this;
+        }
+
+        [[nodiscard]] explicit operator bool() const {return bool(state.indirect_buffer);}
+
+        // Starts a new frame, discarding the previous draws.
+        void BeginFrame(Gpu::Device &device);
+
+        // Adds a draw of vertices from `vertex_buffer`, which will be bound at offset zero. Use `args.first_vertex` to select the vertices.
+        void AddDraw(Gpu::Buffer &vertex_buffer, const Gpu::RenderPass::IndirectDraw &args);
+        // Adds a draw using an index buffer. Both buffers will be bound at offset zero.
+        void AddIndexedDraw(Gpu::Buffer &vertex_buffer, Gpu::Buffer &index_buffer, Gpu::RenderPass::IndexSize index_size, const Gpu::RenderPass::IndirectIndexedDraw &args);
+
+        // Those draw entire meshes from a `Gpu::BufferArena`. The ranges must be allocated with an alignment of `vertex_size` and the index size respectively.
+        void AddDraw(const Gpu::BufferArena::Range &vertices, std::uint32_t vertex_size, std::uint32_t num_instances = 1, std::uint32_t first_instance = 0);
+        void AddIndexedDraw(const Gpu::BufferArena::Range &vertices, std::uint32_t vertex_size, const Gpu::BufferArena::Range &indices, Gpu::RenderPass::IndexSize index_size, std::uint32_t num_instances = 1, std::uint32_t first_instance = 0);
+
+        // The number of draws added in this frame.
+        [[nodiscard]] std::size_t NumDraws() const;
+        // The number of indirect draw calls that `Draw()` will make.
+        [[nodiscard]] std::size_t NumDrawCalls() const {return state.groups.size();}
+
+        // Uploads the draw arguments. Returns the number of bytes uploaded.
+        std::uint32_t FinishFrame(Gpu::CopyPass &pass);
+
+        // Binds the buffers and issues the draws. Bind the pipeline (and the rest of the resources) before calling this.
+        // `vertex_buffer_slot` is what's passed to `RenderPass::BindVertexBuffers()`. Other vertex buffers (e.g. per-instance ones) can be bound to other slots.
+        // Can be called several times per frame, e.g. to draw the same meshes into several targets.
+        void Draw(Gpu::RenderPass &pass, std::uint32_t vertex_buffer_slot = 0);
+    };
+}
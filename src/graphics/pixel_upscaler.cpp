@@ -61,7 +61,7 @@ namespace em::Graphics
             .size = size.to_vec3(1),
         }),
         sampler1(device, {.filter_min = Gpu::Sampler::Filter::nearest, .filter_mag = Gpu::Sampler::Filter::nearest}),
-        pipeline1(device, Gpu::Pipeline::Params{
+        pipeline1(Gpu::Pipeline::Params{
             .shaders = shader,
             .vertex_buffers = {Gpu::ReflectedVertexLayout<Vertex>{}},
             .targets = {{Gpu::Pipeline::ColorTarget{}}},
@@ -69,7 +69,7 @@ namespace em::Graphics
         // `tex2` is constructed lazily, because its size can change.
         sampler2(device, {.filter_min = Gpu::Sampler::Filter::linear, .filter_mag = Gpu::Sampler::Filter::linear}),
         pipeline2(Gpu::Pipeline::Params{
-            // Here parameters appear to be the same as for `pipeline1`, but since this one is actually a `DynamicPipeline`, it will have the output format updated on the fly.
+            // Here parameters appear to be the same as for `pipeline1`, but this one will actually have the output format updated on the fly.
             .shaders = shader,
             .vertex_buffers = {Gpu::ReflectedVertexLayout<Vertex>{}},
             .targets = {{Gpu::Pipeline::ColorTarget{}}},
@@ -110,6 +110,8 @@ namespace em::Graphics
         state.user_render_pass = {};
 
         { // Upscale by an integral amount.
+            state.resources->pipeline1.RequestOutputFormat(*state.device, state.resources->tex2.GetFormat());
+
             Gpu::RenderPass rp(*state.cmdbuf, {.color_targets = {Gpu::RenderPass::ColorTarget{
                 .texture = {&state.resources->tex2},
                 .initial_contents = Gpu::RenderPass::DontCare{},
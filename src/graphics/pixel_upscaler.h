@@ -26,7 +26,8 @@ namespace em::Graphics
             // The nearest sampler for this texture.
             Gpu::Sampler sampler1;
             // The pipeline to render from `tex1` to `tex2`.
-            Gpu::Pipeline pipeline1;
+            // The output format here is fixed, but this is still a `DynamicPipeline` to pick up the reloaded shaders.
+            Gpu::DynamicPipeline pipeline1;
 
             // The second texture, upscaled by an integral amount.
             Gpu::Texture tex2;
@@ -6,23 +6,57 @@
 
 #include "strings/trim.h"
 
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
 namespace em::Graphics
 {
-    ShaderProgram Renderer2d::Resources::shader(
-        "Renderer2d",
-        (std::string)R"(
-            #version 460
+    namespace
+    {
+        // The vertex shader inputs for each vertex type.
+        // The shader body expects `a_pos`, `a_color`, `a_texcoord`, and `a_factors` of types `vec2`, `vec4`, `vec2`, `vec3` respectively,
+        //   so for integer attributes we add macros that convert them to floats.
+        template <typename VertexT>
+        constexpr std::string_view vertex_inputs = {};
+
+        template <>
+        constexpr std::string_view vertex_inputs<Renderer2dVertex> = R"(
+            layout(location = 0) in vec2 a_pos;
+            layout(location = 1) in vec4 a_color;
+            layout(location = 2) in vec2 a_texcoord;
+            layout(location = 3) in vec3 a_factors;
+        )"_compact;
+
+        template <>
+        constexpr std::string_view vertex_inputs<Renderer2dPackedVertex> = R"(
+            layout(location = 0) in vec2 a_pos;
+            layout(location = 1) in uvec4 a_color_u8;
+            layout(location = 2) in vec2 a_texcoord;
+            layout(location = 3) in uvec4 a_factors_u8;
 
+            #define a_color (vec4(a_color_u8) / 255)
+            #define a_factors (vec3(a_factors_u8.xyz) / 255)
+        )"_compact;
+
+        #if __STDCPP_FLOAT16_T__
+        // Half-floats are read as regular floats, so only the integer attributes need converting.
+        template <>
+        constexpr std::string_view vertex_inputs<Renderer2dCompactVertex> = vertex_inputs<Renderer2dPackedVertex>;
+        #endif
+
+        // This goes after the inputs.
+        constexpr std::string_view vertex_shader_body = R"(
             layout(set = 1, binding = 0) uniform Uni
             {
                 vec2 u_scr_size;
             };
 
-            layout(location = 0) in vec2 a_pos;
-            layout(location = 1) in vec4 a_color;
-            layout(location = 2) in vec2 a_texcoord;
-            layout(location = 3) in vec3 a_factors;
-
             layout(location = 0) out vec4 v_color;
             layout(location = 1) out vec2 v_texcoord;
             layout(location = 2) out vec3 v_factors;
@@ -34,42 +68,76 @@ namespace em::Graphics
                 v_texcoord = a_texcoord;
                 v_factors = a_factors;
             }
-        )"_compact,
-        (std::string)R"(
-            #version 460
+        )"_compact;
 
-            layout(set = 2, binding = 0) uniform sampler2D u_texture;
-
-            layout(set = 3, binding = 0) uniform Uni
-            {
-                vec2 u_tex_size;
-            };
-
-
-            layout(location = 0) in vec4 v_color;
-            layout(location = 1) in vec2 v_texcoord;
-            layout(location = 2) in vec3 v_factors;
-
-            layout(location = 0) out vec4 out_color;
+        // The fragment shader is shared by all vertex types.
+        // This is a function to avoid the static init order fiasco with the static shaders of the renderers, since those are templated and get initialized in an unspecified order.
+        [[nodiscard]] const std::shared_ptr<Shader> &FragmentShader()
+        {
+            static const auto ret = std::make_shared<Shader>(
+                "Renderer2d",
+                Gpu::Shader::Stage::fragment,
+                (std::string)R"(
+                    #version 460
+
+                    layout(set = 2, binding = 0) uniform sampler2D u_texture;
+
+                    layout(set = 3, binding = 0) uniform Uni
+                    {
+                        vec2 u_tex_size;
+                    };
+
+
+                    layout(location = 0) in vec4 v_color;
+                    layout(location = 1) in vec2 v_texcoord;
+                    layout(location = 2) in vec3 v_factors;
+
+                    layout(location = 0) out vec4 out_color;
+
+                    void main()
+                    {
+                        vec4 tex_color = texture(u_texture, v_texcoord / u_tex_size);
+                        out_color = vec4(mix(v_color.rgb, tex_color.rgb, v_factors.x),
+                                         mix(v_color.a  , tex_color.a  , v_factors.y));
+
+                        out_color.rgb *= out_color.a;
+                        out_color.a *= v_factors.z;
+                    }
+                )"_compact
+            );
+            return ret;
+        }
 
-            void main()
-            {
-                vec4 tex_color = texture(u_texture, v_texcoord / u_tex_size);
-                out_color = vec4(mix(v_color.rgb, tex_color.rgb, v_factors.x),
-                                 mix(v_color.a  , tex_color.a  , v_factors.y));
+        // The shader name for each vertex type. Those must be unique, since each vertex type has its own vertex shader.
+        template <typename VertexT> constexpr std::string_view shader_name = {};
+        template <> constexpr std::string_view shader_name<Renderer2dVertex> = "Renderer2d";
+        template <> constexpr std::string_view shader_name<Renderer2dPackedVertex> = "Renderer2d_Packed";
+        #if __STDCPP_FLOAT16_T__
+        template <> constexpr std::string_view shader_name<Renderer2dCompactVertex> = "Renderer2d_Compact";
+        #endif
+    }
 
-                out_color.rgb *= out_color.a;
-                out_color.a *= v_factors.z;
-            }
-        )"_compact
+    static_assert(sizeof(Renderer2dVertex) == 44);
+    static_assert(sizeof(Renderer2dPackedVertex) == 24);
+    #if __STDCPP_FLOAT16_T__
+    static_assert(sizeof(Renderer2dCompactVertex) == 16);
+    #endif
+
+    template <typename VertexT>
+    ShaderProgram BasicRenderer2d<VertexT>::Resources::shader(
+        std::make_shared<Shader>(
+            std::string(shader_name<VertexT>),
+            Gpu::Shader::Stage::vertex,
+            fmt::format("#version 460\n\n{}\n{}", vertex_inputs<VertexT>, vertex_shader_body)
+        ),
+        FragmentShader()
     );
 
-    Renderer2d::Resources::Resources(Gpu::Device &device, const Params &params)
+    template <typename VertexT>
+    BasicRenderer2d<VertexT>::Resources::Resources(Gpu::Device &device, const Params &params)
         : params(params)
     {
-        std::uint32_t byte_size = std::uint32_t(params.num_triangles * 3 * sizeof(Vertex));
-        buffer = Gpu::Buffer(device, byte_size);
-        transfer_buffer = Gpu::TransferBuffer(device, byte_size);
+        vertices = StreamingBuffer(device, std::uint32_t(params.num_triangles * 3 * sizeof(Vertex)));
         sampler = Gpu::Sampler(device, Gpu::Sampler::Params{.filter_min = Gpu::Sampler::Filter::nearest, .filter_mag = Gpu::Sampler::Filter::nearest});
 
         pipeline = Gpu::Pipeline::Params{
@@ -82,26 +150,8 @@ namespace em::Graphics
         };
     }
 
-    void Renderer2d::BeginRendering()
-    {
-        state.mapping = state.resources->transfer_buffer.Map();
-        state.vertex_pos_in_buffer = 0;
-    }
-
-    void Renderer2d::EndRendering()
-    {
-        state.mapping = {};
-        state.resources->transfer_buffer.ApplyToBuffer(*state.copy_pass, 0, state.resources->buffer, 0, std::uint32_t(state.vertex_pos_in_buffer * sizeof(Vertex)));
-
-        // We have to call this again when `ApplyToBuffer()` cycles the buffer.
-        state.render_pass->BindVertexBuffers({{
-            {.buffer = &state.resources->buffer},
-        }});
-
-        state.render_pass->DrawPrimitives(std::uint32_t(state.vertex_pos_in_buffer));
-    }
-
-    Renderer2d::Renderer2d(Gpu::Device &device, Resources &resources, Gpu::CommandBuffer &render_cmdbuf, Gpu::RenderPass &render_pass, Gpu::CopyPass &copy_pass, SDL_GPUTextureFormat output_format, ivec2 viewport_size)
+    template <typename VertexT>
+    BasicRenderer2d<VertexT>::BasicRenderer2d(Gpu::Device &device, Resources &resources, Gpu::CommandBuffer &render_cmdbuf, Gpu::RenderPass &render_pass, Gpu::CopyPass &copy_pass, SDL_GPUTextureFormat output_format, ivec2 viewport_size)
     {
         resources.pipeline.RequestOutputFormat(device, output_format);
 
@@ -123,34 +173,119 @@ namespace em::Graphics
 
         state.render_pass->BindPipeline(state.resources->pipeline);
 
-        BeginRendering();
+        // The first renderer creates the quad indices.
+        if (!state.resources->quad_indices)
+        {
+            std::vector<std::uint16_t> indices(max_quads_per_draw_call * 6);
+            for (std::size_t i = 0; i < max_quads_per_draw_call; i++)
+            {
+                auto base = std::uint16_t(i * 4);
+                std::uint16_t *quad = &indices[i * 6];
+                quad[0] = base;
+                quad[1] = std::uint16_t(base + 1);
+                quad[2] = std::uint16_t(base + 2);
+                quad[3] = base;
+                quad[4] = std::uint16_t(base + 2);
+                quad[5] = std::uint16_t(base + 3);
+            }
+            state.resources->quad_indices = Gpu::Buffer(device, copy_pass, indices, Gpu::Buffer::Usage::index);
+        }
+
+        state.resources->batches.clear();
+        state.resources->vertices.BeginFrame(device);
     }
 
-    Renderer2d::~Renderer2d()
+    template <typename VertexT>
+    BasicRenderer2d<VertexT>::~BasicRenderer2d()
     {
         if (!state.resources)
             return; // A null instance, do nothing.
 
-        EndRendering();
-    }
+        std::uint32_t num_bytes = state.resources->vertices.FinishFrame(*state.copy_pass);
+        if (num_bytes == 0)
+            return;
 
-    void Renderer2d::DrawVertices(std::span<const Vertex> vertices)
-    {
-        assert(vertices.size() % 3 == 0);
+        // Must bind this every time, since the upload cycles the buffer.
+        state.render_pass->BindVertexBuffers({{
+            {.buffer = &state.resources->vertices.GetBuffer()},
+        }});
+
+        bool index_buffer_bound = false;
 
-        while (!vertices.empty())
+        for (const typename Resources::Batch &batch : state.resources->batches)
         {
-            std::size_t num_vertices_in_chunk = std::min(vertices.size(), RemainingVertexCapacity());
+            if (!batch.quads)
+            {
+                state.render_pass->DrawPrimitives(batch.num_vertices, batch.first_vertex);
+                continue;
+            }
 
-            std::copy_n(vertices.data(), num_vertices_in_chunk, state.mapping.AsRangeOf<Vertex>().data() + state.vertex_pos_in_buffer);
-            state.vertex_pos_in_buffer += num_vertices_in_chunk;
-            vertices = vertices.subspan(num_vertices_in_chunk);
+            if (!index_buffer_bound)
+            {
+                state.render_pass->BindIndexBuffer({.buffer = &state.resources->quad_indices});
+                index_buffer_bound = true;
+            }
 
-            if (RemainingVertexCapacity() == 0)
+            // The indices are 16-bit, so split long batches into several draw calls, offsetting the vertices instead of the indices.
+            for (std::uint32_t i = 0; i < batch.num_vertices; i += max_quads_per_draw_call * 4)
             {
-                EndRendering();
-                BeginRendering();
+                std::uint32_t num_quads = std::min(std::uint32_t(batch.num_vertices - i) / 4, std::uint32_t(max_quads_per_draw_call));
+                state.render_pass->DrawIndexedPrimitives(num_quads * 6, 0, std::int32_t(batch.first_vertex + i));
             }
         }
     }
+
+    template <typename VertexT>
+    auto BasicRenderer2d<VertexT>::AllocateVertices(std::size_t num_vertices, bool quads) -> std::span<Vertex>
+    {
+        std::uint32_t first_vertex = 0;
+        std::span<Vertex> ret = state.resources->vertices.template AllocateElems<Vertex>(num_vertices, &first_vertex);
+
+        // Extend the last batch if possible. This can fail if the allocation wasn't contiguous with it, which shouldn't normally happen.
+        auto &batches = state.resources->batches;
+        if (!batches.empty() && batches.back().quads == quads && batches.back().first_vertex + batches.back().num_vertices == first_vertex)
+            batches.back().num_vertices += std::uint32_t(num_vertices);
+        else
+            batches.push_back({.quads = quads, .first_vertex = first_vertex, .num_vertices = std::uint32_t(num_vertices)});
+
+        return ret;
+    }
+
+    template <typename VertexT>
+    void BasicRenderer2d<VertexT>::DrawVertices(std::span<const Vertex> vertices)
+    {
+        assert(vertices.size() % 3 == 0);
+
+        if (vertices.empty())
+            return;
+
+        std::ranges::copy(vertices, AllocateVertices(vertices.size(), false).begin());
+    }
+
+    template <typename VertexT>
+    void BasicRenderer2d<VertexT>::DrawQuads(std::span<const Vertex> vertices)
+    {
+        assert(vertices.size() % 4 == 0);
+
+        if (vertices.empty())
+            return;
+
+        std::ranges::copy(vertices, AllocateVertices(vertices.size(), true).begin());
+    }
+
+    template <typename VertexT>
+    void BasicRenderer2d<VertexT>::DrawSprite(fvec2 pos, fvec2 size, fvec2 tex_pos, fvec2 tex_size, float alpha, float beta)
+    {
+        std::span<Vertex> quad = AllocateVertices(4, true);
+        quad[0] = Vertex(pos                   , tex_pos                        , alpha, beta);
+        quad[1] = Vertex(pos + fvec2(size.x, 0), tex_pos + fvec2(tex_size.x, 0), alpha, beta);
+        quad[2] = Vertex(pos + size            , tex_pos + tex_size             , alpha, beta);
+        quad[3] = Vertex(pos + fvec2(0, size.y), tex_pos + fvec2(0, tex_size.y), alpha, beta);
+    }
+
+    template class BasicRenderer2d<Renderer2dVertex>;
+    template class BasicRenderer2d<Renderer2dPackedVertex>;
+    #if __STDCPP_FLOAT16_T__
+    template class BasicRenderer2d<Renderer2dCompactVertex>;
+    #endif
 }
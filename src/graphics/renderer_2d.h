@@ -3,55 +3,131 @@
 #include "em/math/vector.h"
 #include "em/meta/reset_on_move.h"
 #include "em/refl/macros/structs.h"
-#include "gpu/buffer.h"
 #include "gpu/command_buffer.h"
 #include "gpu/copy_pass.h"
 #include "gpu/device.h"
 #include "gpu/render_pass.h"
 #include "gpu/sampler.h"
 #include "gpu/texture.h"
-#include "gpu/transfer_buffer.h"
 #include "graphics/shader_manager.h"
+#include "graphics/streaming_buffer.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <span>
+#include <stdfloat>
+#include <vector>
 
 namespace em::Graphics
 {
-    // `Renderer2d` itself needs to be recreated every frame.
-    // `Renderer2d::Resources` should persist across frames.
-    class Renderer2d
+    // The vertex types supported by `BasicRenderer2d`. They all have the same constructors, and differ only in size and precision.
+    // Each of them needs the matching vertex shader inputs in `renderer_2d.cpp`, and an explicit instantiation of the renderer there.
+
+    // Everything is stored in floats. 44 bytes.
+    struct Renderer2dVertex
     {
-      public:
-        struct Vertex
+        EM_REFL(
+            (fvec2)(pos)
+            (fvec4)(color)
+            (fvec2)(texcoord)
+
+            // X - color mixing: 0 = `color.rgb`, 1 = texture.
+            // X - alpha mixing: 0 = `color.a`, 1 = texture.
+            // X - blending mode: 1 = normal blending, 0 = additive blending.
+            (fvec3)(factors)
+        )
+
+        constexpr Renderer2dVertex() {}
+        constexpr Renderer2dVertex(fvec2 pos, fvec4 color,                                                                            float beta = 1) : pos(pos), color(color), factors(0, 0, beta) {}
+        constexpr Renderer2dVertex(fvec2 pos,              fvec2 texcoord, float alpha = 1,                                           float beta = 1) : pos(pos), texcoord(texcoord), factors(1, alpha, beta) {}
+        constexpr Renderer2dVertex(fvec2 pos, fvec4 color, fvec2 texcoord,                  float mix_color = 1, float mix_alpha = 1, float beta = 1) : pos(pos), color(color), texcoord(texcoord), factors(mix_color, mix_alpha, beta) {}
+    };
+
+    namespace detail
+    {
+        // Converts from 0..1 to 0..255, with rounding and clamping.
+        [[nodiscard]] constexpr std::uint8_t PackUnorm8(float value)
         {
-            EM_REFL(
-                (fvec2)(pos)
-                (fvec4)(color)
-                (fvec2)(texcoord)
-
-                // X - color mixing: 0 = `color.rgb`, 1 = texture.
-                // X - alpha mixing: 0 = `color.a`, 1 = texture.
-                // X - blending mode: 1 = normal blending, 0 = additive blending.
-                (fvec3)(factors)
-            )
+            return std::uint8_t(std::clamp(value, 0.f, 1.f) * 255 + 0.5f);
+        }
+        [[nodiscard]] constexpr u8vec4 PackUnorm8(fvec4 value)
+        {
+            return u8vec4(PackUnorm8(value.x), PackUnorm8(value.y), PackUnorm8(value.z), PackUnorm8(value.w));
+        }
+    }
 
-            constexpr Vertex() {}
-            constexpr Vertex(fvec2 pos, fvec4 color,                                                                            float beta = 1) : pos(pos), color(color), factors(0, 0, beta) {}
-            constexpr Vertex(fvec2 pos,              fvec2 texcoord, float alpha = 1,                                           float beta = 1) : pos(pos), texcoord(texcoord), factors(1, alpha, beta) {}
-            constexpr Vertex(fvec2 pos, fvec4 color, fvec2 texcoord,                  float mix_color = 1, float mix_alpha = 1, float beta = 1) : pos(pos), color(color), texcoord(texcoord), factors(mix_color, mix_alpha, beta) {}
-        };
+    // The color and the factors are stored in 8-bit integers. 24 bytes.
+    // The precision of the color is the same as in a typical 8-bit texture, so this shouldn't lose anything in practice.
+    struct Renderer2dPackedVertex
+    {
+        EM_REFL(
+            (fvec2)(pos)
+            (u8vec4)(color)
+            (fvec2)(texcoord)
+            // Same as in `Renderer2dVertex`. The last component is unused.
+            (u8vec4)(factors)
+        )
+
+        constexpr Renderer2dPackedVertex() {}
+        constexpr Renderer2dPackedVertex(fvec2 pos, fvec4 color,                                                                            float beta = 1) : pos(pos), color(detail::PackUnorm8(color)), factors(detail::PackUnorm8(fvec4(0, 0, beta, 0))) {}
+        constexpr Renderer2dPackedVertex(fvec2 pos,              fvec2 texcoord, float alpha = 1,                                           float beta = 1) : pos(pos), texcoord(texcoord), factors(detail::PackUnorm8(fvec4(1, alpha, beta, 0))) {}
+        constexpr Renderer2dPackedVertex(fvec2 pos, fvec4 color, fvec2 texcoord,                  float mix_color = 1, float mix_alpha = 1, float beta = 1) : pos(pos), color(detail::PackUnorm8(color)), texcoord(texcoord), factors(detail::PackUnorm8(fvec4(mix_color, mix_alpha, beta, 0))) {}
+    };
+
+    #if __STDCPP_FLOAT16_T__
+    // Same as `Renderer2dPackedVertex`, but the position and the texture coordinates are half-floats. 16 bytes.
+    // Half-floats only represent integers exactly up to 2048, so don't use this with larger viewports or textures.
+    struct Renderer2dCompactVertex
+    {
+        EM_REFL(
+            (vec2<std::float16_t>)(pos)
+            (u8vec4)(color)
+            (vec2<std::float16_t>)(texcoord)
+            // Same as in `Renderer2dVertex`. The last component is unused.
+            (u8vec4)(factors)
+        )
+
+        constexpr Renderer2dCompactVertex() {}
+        constexpr Renderer2dCompactVertex(fvec2 pos, fvec4 color,                                                                            float beta = 1) : pos(pos.to<std::float16_t>()), color(detail::PackUnorm8(color)), factors(detail::PackUnorm8(fvec4(0, 0, beta, 0))) {}
+        constexpr Renderer2dCompactVertex(fvec2 pos,              fvec2 texcoord, float alpha = 1,                                           float beta = 1) : pos(pos.to<std::float16_t>()), texcoord(texcoord.to<std::float16_t>()), factors(detail::PackUnorm8(fvec4(1, alpha, beta, 0))) {}
+        constexpr Renderer2dCompactVertex(fvec2 pos, fvec4 color, fvec2 texcoord,                  float mix_color = 1, float mix_alpha = 1, float beta = 1) : pos(pos.to<std::float16_t>()), color(detail::PackUnorm8(color)), texcoord(texcoord.to<std::float16_t>()), factors(detail::PackUnorm8(fvec4(mix_color, mix_alpha, beta, 0))) {}
+    };
+    #endif
+
+    // `BasicRenderer2d` itself needs to be recreated every frame.
+    // `BasicRenderer2d::Resources` should persist across frames.
+    // `VertexT` is one of the vertex types above. Use the `...Renderer2d` typedefs below instead of using this directly.
+    template <typename VertexT>
+    class BasicRenderer2d
+    {
+      public:
+        using Vertex = VertexT;
 
         struct Params
         {
+            // The initial capacity. If a frame needs more, the storage grows automatically (see `StreamingBuffer`).
             std::size_t num_triangles = 1024;
 
             // Not optional. SDL doesn't let you just omit textures if the shader uses them.
             Gpu::Texture *texture = nullptr;
         };
 
+        // How many quads one indexed draw call can handle. This is limited by 16-bit indices.
+        static constexpr std::size_t max_quads_per_draw_call = 0x10000 / 4;
+
         class Resources
         {
-            friend Renderer2d;
+            friend BasicRenderer2d;
+
+            // A range of consecutive vertices in `vertices`, drawn in the same way.
+            struct Batch
+            {
+                // If true, this is made of quads (4 vertices each, indexed), otherwise of triangles (3 vertices each).
+                bool quads = false;
+
+                std::uint32_t first_vertex = 0;
+                std::uint32_t num_vertices = 0;
+            };
 
             EM_REFL(
                 (ShaderProgram)(static shader)
@@ -59,8 +135,15 @@ namespace em::Graphics
 
             Params params;
 
-            Gpu::Buffer buffer;
-            Gpu::TransferBuffer transfer_buffer;
+            // The vertices of the current frame. All of them are uploaded and drawn at once when the renderer is destroyed.
+            StreamingBuffer vertices;
+            // The batches of the current frame, in drawing order. This is here rather than in the renderer itself to reuse the memory across frames.
+            std::vector<Batch> batches;
+
+            // The indices for drawing quads: `0,1,2, 0,2,3`, then the same plus 4, and so on, for `max_quads_per_draw_call` quads.
+            // This never changes. It's created by the first renderer, because we need a copy pass for that.
+            Gpu::Buffer quad_indices;
+
             Gpu::Sampler sampler;
 
             Gpu::DynamicPipeline pipeline;
@@ -78,35 +161,52 @@ namespace em::Graphics
             Gpu::RenderPass *render_pass = nullptr;
             Gpu::CopyPass *copy_pass = nullptr;
 
-            Gpu::TransferBuffer::Mapping mapping;
-
-            std::size_t vertex_pos_in_buffer = 0;
-
             // Need this to make Clang happy in `ResetMovedFromStruct<...>` below.
             constexpr State() {}
         };
         Meta::ResetMovedFromStruct<State> state;
 
-        void BeginRendering();
-        void EndRendering();
+        // Allocates space for vertices, and adds them to the current batch, or starts a new one if `quads` differs.
+        [[nodiscard]] std::span<Vertex> AllocateVertices(std::size_t num_vertices, bool quads);
 
       public:
-        constexpr Renderer2d() {}
+        constexpr BasicRenderer2d() {}
 
         // Before calling this, you must have a render command buffer and a copy command buffer, and start render and copy passes on them respectively.
         // After the destructor runs, you must submit `copy_pass` and then `render_pass`, in this order.
+        // Nothing is drawn until the destructor, which uploads all vertices at once and then draws them in order,
+        //   with one draw call per run of triangles or quads.
         // `viewport_size` only affects how the input coordinates are mapped to NDC.
-        Renderer2d(Gpu::Device &device, Resources &resources, Gpu::CommandBuffer &render_cmdbuf, Gpu::RenderPass &render_pass, Gpu::CopyPass &copy_pass, SDL_GPUTextureFormat output_format, ivec2 viewport_size);
+        BasicRenderer2d(Gpu::Device &device, Resources &resources, Gpu::CommandBuffer &render_cmdbuf, Gpu::RenderPass &render_pass, Gpu::CopyPass &copy_pass, SDL_GPUTextureFormat output_format, ivec2 viewport_size);
 
-        Renderer2d(Renderer2d &&) = default;
-        Renderer2d &operator=(Renderer2d &&) = default;
+        BasicRenderer2d(BasicRenderer2d &&) = default;
+        BasicRenderer2d &operator=(BasicRenderer2d &&) = default;
 
-        ~Renderer2d();
+        ~BasicRenderer2d();
 
-        [[nodiscard]] std::size_t VertexCapacity() const {return state.resources->params.num_triangles * 3;}
-        [[nodiscard]] std::size_t RemainingVertexCapacity() const {return VertexCapacity() - state.vertex_pos_in_buffer;}
+        // How many vertices fit before we have to allocate more memory. This is only informational, exceeding this is fine.
+        [[nodiscard]] std::size_t VertexCapacity() const {return state.resources->vertices.Capacity() / sizeof(Vertex);}
 
         // Must send the vertices in multiples of three.
         void DrawVertices(std::span<const Vertex> vertices);
+
+        // Must send the vertices in multiples of four. Each quad is `a,b,c,d` in order around the perimeter, in any winding direction.
+        // This uses 4 vertices per quad instead of 6 that `DrawVertices()` would need.
+        void DrawQuads(std::span<const Vertex> vertices);
+
+        // Draws an axis-aligned textured rectangle. `tex_pos` and `tex_size` are in pixels.
+        void DrawSprite(fvec2 pos, fvec2 size, fvec2 tex_pos, fvec2 tex_size, float alpha = 1, float beta = 1);
     };
+
+    extern template class BasicRenderer2d<Renderer2dVertex>;
+    extern template class BasicRenderer2d<Renderer2dPackedVertex>;
+    #if __STDCPP_FLOAT16_T__
+    extern template class BasicRenderer2d<Renderer2dCompactVertex>;
+    #endif
+
+    using Renderer2d = BasicRenderer2d<Renderer2dVertex>;
+    using PackedRenderer2d = BasicRenderer2d<Renderer2dPackedVertex>;
+    #if __STDCPP_FLOAT16_T__
+    using CompactRenderer2d = BasicRenderer2d<Renderer2dCompactVertex>;
+    #endif
 }
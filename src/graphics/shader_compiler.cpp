@@ -0,0 +1,224 @@
+#include "shader_compiler.h"
+
+#include "utils/filesystem.h"
+#include "utils/process_queue.h"
+#include "utils/terminal.h"
+
+#include <fmt/format.h>
+#include <glslang/Include/glslang_c_interface.h>
+#include <glslang/Public/resource_limits_c.h>
+
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+
+namespace em::Graphics
+{
+    std::vector<blob> GlslcShaderCompiler::Compile(std::span<const Task> tasks)
+    {
+        std::vector<ProcessQueue::Task> queue_tasks;
+        queue_tasks.reserve(tasks.size());
+
+        for (const Task &task : tasks)
+        {
+            std::string_view stage_name;
+            switch (task.stage)
+            {
+              case Gpu::Shader::Stage::vertex:
+                stage_name = "vert";
+                break;
+              case Gpu::Shader::Stage::fragment:
+                stage_name = "frag";
+                break;
+              case Gpu::Shader::Stage::compute:
+                stage_name = "comp";
+                break;
+            }
+
+            std::vector<std::string> command = {"glslc", fmt::format("-fshader-stage={}", stage_name), "-", fmt::format("-o{}", task.output_path)};
+            command.append_range(flags);
+
+            queue_tasks.push_back({
+                .name = task.name,
+                .command = std::move(command),
+                .input = std::string(task.source),
+            });
+        }
+
+        ProcessQueue queue(std::move(queue_tasks));
+        auto status = queue.WaitUntilFinished();
+        if (status.num_failed > 0)
+            throw std::runtime_error("Some shaders failed to compile!");
+
+        // `glslc` can only give us the binaries through the files.
+        std::vector<blob> ret;
+        ret.reserve(tasks.size());
+        for (const Task &task : tasks)
+            ret.push_back(Filesystem::FileContents(task.output_path));
+        return ret;
+    }
+
+    GlslangShaderCompiler::GlslangShaderCompiler()
+    {
+        // This is reference-counted, so having several instances of this class is fine.
+        glslang_initialize_process();
+    }
+
+    GlslangShaderCompiler::~GlslangShaderCompiler()
+    {
+        // Stop the threads first, just in case.
+        thread_pool = {};
+
+        glslang_finalize_process();
+    }
+
+    std::vector<blob> GlslangShaderCompiler::Compile(std::span<const Task> tasks)
+    {
+        struct Result
+        {
+            bool success = false;
+            std::string binary;
+            // The errors and warnings.
+            std::string log;
+        };
+
+        std::vector<Result> results(tasks.size());
+
+        auto CompileOne = [](const Task &task, Result &result)
+        {
+            auto AppendLog = [&](const char *log)
+            {
+                if (log && *log)
+                {
+                    result.log += log;
+                    if (!result.log.ends_with('\n'))
+                        result.log += '\n';
+                }
+            };
+
+            glslang_stage_t stage{};
+            switch (task.stage)
+            {
+              case Gpu::Shader::Stage::vertex:
+                stage = GLSLANG_STAGE_VERTEX;
+                break;
+              case Gpu::Shader::Stage::fragment:
+                stage = GLSLANG_STAGE_FRAGMENT;
+                break;
+              case Gpu::Shader::Stage::compute:
+                stage = GLSLANG_STAGE_COMPUTE;
+                break;
+            }
+
+            // Those match the `glslc` defaults.
+            const glslang_input_t input = {
+                .language = GLSLANG_SOURCE_GLSL,
+                .stage = stage,
+                .client = GLSLANG_CLIENT_VULKAN,
+                .client_version = GLSLANG_TARGET_VULKAN_1_0,
+                .target_language = GLSLANG_TARGET_SPV,
+                .target_language_version = GLSLANG_TARGET_SPV_1_0,
+                .code = task.source.c_str(),
+                .default_version = 100,
+                .default_profile = GLSLANG_NO_PROFILE,
+                .force_default_version_and_profile = false,
+                .forward_compatible = false,
+                .messages = glslang_messages_t(GLSLANG_MSG_SPV_RULES_BIT | GLSLANG_MSG_VULKAN_RULES_BIT),
+                .resource = glslang_default_resource(),
+            };
+
+            std::unique_ptr<glslang_shader_t, decltype(&glslang_shader_delete)> shader(glslang_shader_create(&input), glslang_shader_delete);
+            if (!shader)
+            {
+                AppendLog("Unable to create a shader object.");
+                return;
+            }
+
+            if (!glslang_shader_preprocess(shader.get(), &input) || !glslang_shader_parse(shader.get(), &input))
+            {
+                AppendLog(glslang_shader_get_info_log(shader.get()));
+                AppendLog(glslang_shader_get_info_debug_log(shader.get()));
+                return;
+            }
+            AppendLog(glslang_shader_get_info_log(shader.get())); // Warnings, if any.
+
+            std::unique_ptr<glslang_program_t, decltype(&glslang_program_delete)> program(glslang_program_create(), glslang_program_delete);
+            glslang_program_add_shader(program.get(), shader.get());
+            if (!glslang_program_link(program.get(), input.messages))
+            {
+                AppendLog(glslang_program_get_info_log(program.get()));
+                AppendLog(glslang_program_get_info_debug_log(program.get()));
+                return;
+            }
+
+            glslang_program_SPIRV_generate(program.get(), stage);
+            AppendLog(glslang_program_SPIRV_get_messages(program.get()));
+
+            result.binary.assign(reinterpret_cast<const char *>(glslang_program_SPIRV_get_ptr(program.get())), glslang_program_SPIRV_get_size(program.get()) * sizeof(unsigned int));
+            result.success = true;
+        };
+
+        if (!thread_pool)
+            thread_pool = ThreadPool(num_threads);
+
+        for (std::size_t i = 0; i < tasks.size(); i++)
+        {
+            thread_pool.Run([&task = tasks[i], &result = results[i], &CompileOne]
+            {
+                try
+                {
+                    CompileOne(task, result);
+                }
+                catch (std::exception &e)
+                {
+                    result.success = false;
+                    result.log += e.what();
+                    result.log += '\n';
+                }
+            });
+        }
+        thread_pool.WaitUntilIdle();
+
+        // Print the results in the same format as `ProcessQueue`, and in the original order to make it deterministic.
+        std::size_t num_failed = 0;
+        for (std::size_t i = 0; i < tasks.size(); i++)
+        {
+            if (results[i].success)
+            {
+                fmt::print(stderr, "[Done] {}\n", tasks[i].name);
+            }
+            else
+            {
+                fmt::print(stderr, "[Failed] {}\n", tasks[i].name);
+                num_failed++;
+            }
+
+            if (!results[i].log.empty())
+            {
+                std::fwrite(results[i].log.data(), results[i].log.size(), 1, stderr);
+                Terminal::SendAnsiResetSequence(stderr);
+            }
+        }
+
+        if (num_failed > 0)
+        {
+            fmt::print(stderr, "-- {}/{} failed! --\n", num_failed, tasks.size());
+            throw std::runtime_error("Some shaders failed to compile!");
+        }
+        fmt::print(stderr, "-- All {} shader{} compiled --\n", tasks.size(), tasks.size() != 1 ? "s" : "");
+
+        // Save the binaries, and hand them over to the caller without reading them back.
+        std::vector<blob> ret;
+        ret.reserve(tasks.size());
+        for (std::size_t i = 0; i < tasks.size(); i++)
+        {
+            Filesystem::File file(tasks[i].output_path, "wb");
+            if (std::fwrite(results[i].binary.data(), results[i].binary.size(), 1, file.Handle()) != 1)
+                throw std::runtime_error(fmt::format("Unable to write the shader binary to `{}`.", tasks[i].output_path));
+
+            ret.push_back(zblob(zblob::Owning{}, std::move(results[i].binary)));
+        }
+        return ret;
+    }
+}
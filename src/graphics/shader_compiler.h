@@ -0,0 +1,66 @@
+#pragma once
+
+#include "em/zstring_view.h"
+#include "gpu/shader.h"
+#include "utils/blob.h"
+#include "utils/thread_pool.h"
+
+#include <span>
+#include <string>
+#include <vector>
+
+namespace em::Graphics
+{
+    // Compiles GLSL shaders to SPIR-V. This is what `ShaderManager` uses to compile the missing shaders.
+    class ShaderCompiler
+    {
+      public:
+        struct Task
+        {
+            // For the diagnostics.
+            std::string name;
+
+            Gpu::Shader::Stage stage{};
+            zstring_view source;
+
+            // Where to save the binary, so that it can be reused on the next run.
+            std::string output_path;
+        };
+
+        virtual ~ShaderCompiler() = default;
+
+        // Compiles the shaders, writes the binaries to the `output_path`s, and also returns them in the same order.
+        // Prints the diagnostics to `stderr`. Throws if any of the shaders failed to compile.
+        // The output directories must already exist.
+        [[nodiscard]] virtual std::vector<blob> Compile(std::span<const Task> tasks) = 0;
+    };
+
+    // Runs a `glslc` process for each shader, several at a time.
+    class GlslcShaderCompiler : public ShaderCompiler
+    {
+      public:
+        // The extra flags to pass to `glslc`.
+        std::vector<std::string> flags = {"-O"};
+
+        [[nodiscard]] std::vector<blob> Compile(std::span<const Task> tasks) override;
+    };
+
+    // Compiles the shaders on a thread pool using `glslang`, without starting any processes.
+    // This doesn't optimize the shaders, since that needs SPIRV-Tools, which we don't link. Use `GlslcShaderCompiler` for the release builds.
+    class GlslangShaderCompiler : public ShaderCompiler
+    {
+        ThreadPool thread_pool;
+
+      public:
+        // Passed to `ThreadPool`. Zero means the number of CPU cores.
+        int num_threads = 0;
+
+        GlslangShaderCompiler();
+        ~GlslangShaderCompiler();
+
+        GlslangShaderCompiler(const GlslangShaderCompiler &) = delete;
+        GlslangShaderCompiler &operator=(const GlslangShaderCompiler &) = delete;
+
+        [[nodiscard]] std::vector<blob> Compile(std::span<const Task> tasks) override;
+    };
+}
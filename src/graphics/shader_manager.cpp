@@ -1,23 +1,81 @@
 #include "shader_manager.h"
 
 #include "command_line/parser.h"
+#include "gpu/async_creator.h"
 #include "strings/char_types.h"
 #include "utils/hash_func.h"
-#include "utils/process_queue.h"
 #include "utils/terminal.h"
 
 #include <fmt/format.h>
 #include <gtl/phmap.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <exception>
 #include <stdexcept>
+#include <utility>
 
 namespace em::Graphics
 {
+    namespace
+    {
+        [[nodiscard]] std::string_view ShaderStageToString(Gpu::Shader::Stage stage)
+        {
+            switch (stage)
+            {
+              case Gpu::Shader::Stage::vertex:
+                return "vertex";
+              case Gpu::Shader::Stage::fragment:
+                return "fragment";
+              case Gpu::Shader::Stage::compute:
+                return "compute";
+            }
+            throw std::logic_error("Invalid shader stage enum.");
+        }
+
+        // The file extension for the stage, same as what `glslc` uses.
+        [[nodiscard]] std::string_view ShaderStageExtension(Gpu::Shader::Stage stage)
+        {
+            switch (stage)
+            {
+              case Gpu::Shader::Stage::vertex:
+                return "vert";
+              case Gpu::Shader::Stage::fragment:
+                return "frag";
+              case Gpu::Shader::Stage::compute:
+                return "comp";
+            }
+            throw std::logic_error("Invalid shader stage enum.");
+        }
+
+        // Tweak the shader name a little, to make it look better as a file name.
+        [[nodiscard]] std::string ShaderFileName(std::string_view name)
+        {
+            std::string ret;
+            ret.reserve(name.size());
+            for (char ch : name)
+            {
+                if (Strings::IsIdentifierCharStrict(ch))
+                {
+                    ret += ch;
+                    continue;
+                }
+
+                if (!ret.empty() && !ret.ends_with('_'))
+                    ret += '_';
+            }
+            while (ret.ends_with('_'))
+                ret.pop_back();
+            return ret;
+        }
+    }
+
     Shader::~Shader()
     {
         // Make sure the `shader` was already destroyed by `ShaderManager`.
         // If it wasn't, it's a sign of the wrong destruction order. See the comment on `Shader` for more details.
-        assert(!shader);
+        assert(!shader && !compute_pipeline);
     }
 
     bool BasicShaderManager::ShaderNameLess::operator()(const Shader *a, const Shader *b)
@@ -51,7 +109,10 @@ namespace em::Graphics
         // This is needed when they are in static variables, to avoid the static deinit order fiasco, when they are destroyed after the Window and GPU get destroyed.
 
         for (Shader *shader : shaders)
+        {
             shader->shader = {};
+            shader->compute_pipeline = {};
+        }
     }
 
     void ShaderManager::Finalize()
@@ -64,78 +125,33 @@ namespace em::Graphics
 
         finalized = true;
 
-        struct CompiledShader
-        {
-            Shader *shader = nullptr;
-            std::string filename;
-        };
+        // Those two vectors are parallel.
+        std::vector<Shader *> compiled_shaders;
+        std::vector<ShaderCompiler::Task> compilation_tasks;
 
-        std::vector<CompiledShader> compiled_shaders;
-        std::vector<ProcessQueue::Task> compilation_tasks;
-
-        auto ShaderStageToString = [](Gpu::Shader::Stage stage) -> std::string_view
-        {
-            switch (stage)
-            {
-              case Gpu::Shader::Stage::vertex:
-                return "vertex";
-              case Gpu::Shader::Stage::fragment:
-                return "fragment";
-            }
-        };
+        // Translating the shaders for the current backend is relatively slow, so we do it on several threads, and wait for them at the end.
+        Gpu::AsyncCreator shader_creator(0);
+        std::vector<std::pair<Shader *, Gpu::AsyncObject<Gpu::Shader>>> pending_shaders;
+        std::vector<std::pair<Shader *, Gpu::AsyncObject<Gpu::ComputePipeline>>> pending_compute_pipelines;
 
-        auto FinalizeShader = [&](Shader &shader, const_byte_view binary)
+        auto FinalizeShader = [&](Shader &shader, blob binary)
         {
-            try
-            {
-                shader.shader = Gpu::Shader(*device, shader.name, shader.stage, binary);
-            }
-            catch (...)
-            {
-                std::throw_with_nested(std::runtime_error(fmt::format("While loading {} shader `{}`:", ShaderStageToString(shader.stage), shader.name)));
-            }
+            if (shader.stage == Gpu::Shader::Stage::compute)
+                pending_compute_pipelines.emplace_back(&shader, shader_creator.CreateComputePipeline(*device, shader.name, std::move(binary)));
+            else
+                pending_shaders.emplace_back(&shader, shader_creator.CreateShader(*device, shader.name, shader.stage, std::move(binary)));
         };
 
         gtl::flat_hash_set<std::string> shader_filenames;
 
         for (Shader *shader : shaders)
         {
-            std::uint32_t hash = Hash32(shader->source);
-
-            std::string_view stage_name;
-            switch (shader->stage)
-            {
-              case Gpu::Shader::Stage::vertex:
-                stage_name = "vert";
-                break;
-              case Gpu::Shader::Stage::fragment:
-                stage_name = "frag";
-                break;
-            }
-
-            // Tweak the shader name a little, to make it look better as a file name.
-            std::string fixed_name;
-            fixed_name.reserve(shader->name.size());
-            for (char ch : shader->name)
-            {
-                if (Strings::IsIdentifierCharStrict(ch))
-                {
-                    fixed_name += ch;
-                    continue;
-                }
-
-                if (!fixed_name.empty() && !fixed_name.ends_with('_'))
-                    fixed_name += '_';
-            }
-            while (fixed_name.ends_with('_'))
-                fixed_name.pop_back();
-
-            std::string filename = fmt::format("{}/{}-{:08x}.{}.spv", dir, fixed_name, hash, stage_name);
+            std::string filename = BinaryPath(shader->name, shader->stage, shader->source);
             shader_filenames.insert(filename);
 
             bool file_was_loaded = true;
             // If `compile_when_finalized == false`, this just throws.
-            Filesystem::LoadedFile file(filename, compile_when_finalized ? &file_was_loaded : nullptr);
+            Filesystem::FileContents file(filename, compile_when_finalized ? &file_was_loaded : nullptr);
 
             if (file_was_loaded)
             {
@@ -147,15 +163,12 @@ namespace em::Graphics
                 // Queue the shader for compilation.
                 // This is reachable only after `CompileWhenFinalized()`.
 
-                compiled_shaders.push_back({.shader = shader, .filename = filename});
-
-                std::vector<std::string> command = {"glslc", fmt::format("-fshader-stage={}", stage_name), "-", fmt::format("-o{}", filename)};
-                command.append_range(glslc_flags);
-
+                compiled_shaders.push_back(shader);
                 compilation_tasks.push_back({
                     .name = fmt::format("{} ({})", shader->name, ShaderStageToString(shader->stage)),
-                    .command = std::move(command),
-                    .input = shader->source,
+                    .stage = shader->stage,
+                    .source = shader->source,
+                    .output_path = filename,
                 });
             }
         }
@@ -173,15 +186,14 @@ namespace em::Graphics
                 // Create the output directory.
                 Filesystem::CreateDirectories(dir);
 
-                ProcessQueue queue(std::move(compilation_tasks));
-                auto status = queue.WaitUntilFinished();
-                if (status.num_failed > 0)
-                    throw std::runtime_error("Some shaders failed to compile!");
+                if (!compiler)
+                    throw std::logic_error("`ShaderManager` needs a shader compiler to compile the missing shaders.");
+
+                std::vector<blob> binaries = compiler->Compile(compilation_tasks);
 
                 // Load the shaders.
-                // `LoadedFile(...)` and `FinalizeShader(...)` can throw, we don't mind that.
-                for (const auto &elem : compiled_shaders)
-                    FinalizeShader(*elem.shader, Filesystem::LoadedFile(elem.filename));
+                for (std::size_t i = 0; i < compiled_shaders.size(); i++)
+                    FinalizeShader(*compiled_shaders[i], binaries[i]);
             }
 
             { // Delete the unwanted files.
@@ -214,6 +226,158 @@ namespace em::Graphics
                 }
             }
         }
+
+        // Wait for the shaders to be created.
+        auto WaitForPending = [&]<typename T>(std::vector<std::pair<Shader *, Gpu::AsyncObject<T>>> &pending, T Shader::*field)
+        {
+            for (auto &[shader, pending_object] : pending)
+            {
+                try
+                {
+                    shader->*field = std::move(*pending_object.Get());
+                }
+                catch (...)
+                {
+                    std::throw_with_nested(std::runtime_error(fmt::format("While loading {} shader `{}`:", ShaderStageToString(shader->stage), shader->name)));
+                }
+            }
+        };
+        WaitForPending(pending_shaders, &Shader::shader);
+        WaitForPending(pending_compute_pipelines, &Shader::compute_pipeline);
+
+        if (!hot_reload_dir.empty())
+            StartHotReload();
+    }
+
+    std::string ShaderManager::BinaryPath(std::string_view name, Gpu::Shader::Stage stage, std::string_view source) const
+    {
+        return fmt::format("{}/{}-{:08x}.{}.spv", dir, ShaderFileName(name), Hash32(source), ShaderStageExtension(stage));
+    }
+
+    void ShaderManager::StartHotReload()
+    {
+        if (!compile_when_finalized)
+            throw std::logic_error("Shader hot reload requires `compile_when_finalized` (`--compile-shaders`), to be able to compile the modified shaders.");
+
+        Filesystem::CreateDirectories(hot_reload_dir);
+
+        hot_reload = std::make_unique<HotReload>();
+        std::vector<Filesystem::FileInfo::TimeType> modify_times;
+
+        for (Shader *shader : shaders)
+        {
+            std::string path = fmt::format("{}/{}.{}", hot_reload_dir, ShaderFileName(shader->name), ShaderStageExtension(shader->stage));
+
+            // Always overwrite the files, so that the edits from the previous runs don't silently override the sources in the code.
+            Filesystem::File file(path, "wb");
+            if (!shader->source.empty() && std::fwrite(shader->source.data(), shader->source.size(), 1, file.Handle()) != 1)
+                throw std::runtime_error(fmt::format("Unable to write the shader source to `{}`.", path));
+            file = {}; // Close the file before checking its time.
+
+            auto info = Filesystem::GetFileInfo(path);
+            modify_times.push_back(info ? info->modify_time : 0);
+
+            hot_reload->shaders.push_back(shader);
+            hot_reload->source_paths.push_back(std::move(path));
+        }
+
+        hot_reload->thread = std::jthread([&watch = *hot_reload, modify_times = std::move(modify_times)](std::stop_token stop) mutable
+        {
+            std::unique_lock lock(watch.mutex);
+
+            while (!stop.stop_requested())
+            {
+                // Don't hold the lock while touching the filesystem. `source_paths` doesn't change, so this is fine.
+                lock.unlock();
+                std::vector<std::size_t> new_changed;
+                for (std::size_t i = 0; i < watch.source_paths.size(); i++)
+                {
+                    auto info = Filesystem::GetFileInfo(watch.source_paths[i]);
+                    Filesystem::FileInfo::TimeType time = info ? info->modify_time : 0;
+                    if (time != modify_times[i])
+                    {
+                        modify_times[i] = time;
+                        new_changed.push_back(i);
+                    }
+                }
+                lock.lock();
+
+                for (std::size_t i : new_changed)
+                {
+                    if (std::find(watch.changed.begin(), watch.changed.end(), i) == watch.changed.end())
+                        watch.changed.push_back(i);
+                }
+
+                // Checking the file times is cheap enough to do this a few times per second.
+                watch.stop_cv.wait_for(lock, stop, std::chrono::milliseconds(250), []{return false;});
+            }
+        });
+
+        Terminal::DefaultToConsole(stderr);
+        fmt::print(stderr, "### Watching the shader sources in `{}` ###\n", hot_reload_dir);
+    }
+
+    bool ShaderManager::ReloadChangedShaders()
+    {
+        if (!hot_reload)
+            return false;
+
+        std::vector<std::size_t> changed;
+        {
+            std::lock_guard lock(hot_reload->mutex);
+            std::swap(changed, hot_reload->changed);
+        }
+
+        bool reloaded_any = false;
+
+        for (std::size_t index : changed)
+        {
+            Shader &shader = *hot_reload->shaders[index];
+            const std::string task_name = fmt::format("{} ({})", shader.name, ShaderStageToString(shader.stage));
+
+            try
+            {
+                // Never memory-map the sources, since they're being edited, and a truncated mapped file crashes on access.
+                std::string new_source(std::string_view(Filesystem::FileContents(hot_reload->source_paths[index], nullptr, Filesystem::FileLoadParams::NeverMap())));
+                if (new_source == shader.source)
+                    continue; // The file was touched, but not actually modified.
+
+                const std::string binary_path = BinaryPath(shader.name, shader.stage, new_source);
+
+                // Reuse the existing binary if we already have one, e.g. if the edit was reverted.
+                bool binary_was_loaded = false;
+                blob binary = Filesystem::FileContents(binary_path, &binary_was_loaded);
+                if (!binary_was_loaded)
+                {
+                    if (!compiler)
+                        throw std::logic_error("`ShaderManager` needs a shader compiler to reload the shaders.");
+
+                    const ShaderCompiler::Task task{
+                        .name = task_name,
+                        .stage = shader.stage,
+                        .source = new_source,
+                        .output_path = binary_path,
+                    };
+                    binary = std::move(compiler->Compile({&task, 1}).front());
+                }
+
+                // This creates the new shader before destroying the old one, so if this throws, we keep the old one.
+                if (shader.stage == Gpu::Shader::Stage::compute)
+                    shader.compute_pipeline = Gpu::ComputePipeline(*device, shader.name, binary);
+                else
+                    shader.shader = Gpu::Shader(*device, shader.name, shader.stage, binary);
+                shader.source = std::move(new_source);
+
+                fmt::print(stderr, "[Reloaded] {}\n", task_name);
+                reloaded_any = true;
+            }
+            catch (std::exception &e)
+            {
+                fmt::print(stderr, "[Failed] Unable to reload {}: {}\n", task_name, e.what());
+            }
+        }
+
+        return reloaded_any;
     }
 
     void ShaderManager::ProvidedCommandLineFlags(CommandLine::Parser &parser)
@@ -236,5 +400,32 @@ namespace em::Graphics
                 Finalize();
             }
         );
+
+        parser.AddFlag<std::string>(
+            "--shader-compiler",
+            {},
+            "name",
+            "The compiler to use with `--compile-shaders`: `glslc` (the default, runs a process per shader) or `glslang` (compiles in-process on several threads, but doesn't optimize).",
+            [this](const std::string &name)
+            {
+                if (name == "glslc")
+                    compiler = std::make_unique<GlslcShaderCompiler>();
+                else if (name == "glslang")
+                    compiler = std::make_unique<GlslangShaderCompiler>();
+                else
+                    throw std::runtime_error(fmt::format("Unknown shader compiler `{}`, expected `glslc` or `glslang`.", name));
+            }
+        );
+
+        parser.AddFlag<std::string>(
+            "--hot-reload-shaders",
+            {},
+            "dir",
+            "Write the shader sources to `dir`, and reload the shaders when those files are edited. Requires `--compile-shaders`.",
+            [this](std::string new_dir)
+            {
+                hot_reload_dir = std::move(new_dir);
+            }
+        );
     }
 }
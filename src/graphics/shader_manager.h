@@ -1,15 +1,22 @@
 #pragma once
 
 #include "em/refl/macros/structs.h"
+#include "gpu/compute_pipeline.h"
 #include "gpu/pipeline.h"
 #include "gpu/shader.h"
+#include "graphics/shader_compiler.h"
 #include "utils/filesystem.h"
 
 #include <fmt/format.h>
 
+#include <condition_variable>
+#include <cstddef>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
 namespace em::CommandLine
@@ -33,10 +40,12 @@ namespace em::Graphics
         std::string name;
         Gpu::Shader::Stage stage{};
         std::string source;
-        Gpu::Shader shader; // This one field is set lazily by `ShaderManager` when it loads the shaders.
+        // One of those two is set lazily by `ShaderManager` when it loads the shaders, depending on the `stage`.
+        Gpu::Shader shader;
+        Gpu::ComputePipeline compute_pipeline; // Only for `Gpu::Shader::Stage::compute`.
 
         constexpr Shader() {}
-        // Only the combination of `name` + `stage` needs to be unique, so don't add "vertex"/"fragment" to your shader names.
+        // Only the combination of `name` + `stage` needs to be unique, so don't add "vertex"/"fragment"/"compute" to your shader names.
         constexpr Shader(std::string name, Gpu::Shader::Stage stage, std::string source) : name(std::move(name)), stage(stage), source(std::move(source)) {}
 
         Shader(Shader &&) = default;
@@ -49,6 +58,12 @@ namespace em::Graphics
         {
             return &shader;
         }
+
+        // To help passing this into `Gpu::ComputePass::BindPipeline()`.
+        operator Gpu::ComputePipeline &()
+        {
+            return compute_pipeline;
+        }
     };
 
     // A shader program managed by the shader manager.
@@ -103,16 +118,45 @@ namespace em::Graphics
     {
         Gpu::Device *device = nullptr;
 
+        // The hot reload state, see `hot_reload_dir`.
+        struct HotReload
+        {
+            // Those two are parallel.
+            std::vector<Shader *> shaders;
+            std::vector<std::string> source_paths;
+
+            std::mutex mutex;
+            // The `shaders` indices that the watcher thread has found to be modified since the last `ReloadChangedShaders()`. Protected by `mutex`.
+            std::vector<std::size_t> changed;
+
+            // The watcher thread waits on this between the checks, so that it can be stopped without waiting for the timeout.
+            std::condition_variable_any stop_cv;
+            // This is last, to be destroyed (stopped) first.
+            std::jthread thread;
+        };
+        std::unique_ptr<HotReload> hot_reload;
+
+        // The path of the compiled shader, which includes a hash of its `source`.
+        [[nodiscard]] std::string BinaryPath(std::string_view name, Gpu::Shader::Stage stage, std::string_view source) const;
+
+        void StartHotReload();
+
       public:
         // The directory where we look for shaders, and possibly place compiled ones if that's enabled.
         std::string dir = fmt::format("{}{}", Filesystem::GetResourceDir(), "assets/shaders");
 
-        // The extra flags to pass to the shader compiler, if `CompileWhenFinalized()` is used.
-        std::vector<std::string> glslc_flags = {"-O"};
+        // Compiles the missing shaders, if `compile_when_finalized` is set.
+        // Can be replaced with `GlslangShaderCompiler` (see `--shader-compiler`), which doesn't start any processes and is faster when many shaders change.
+        std::unique_ptr<ShaderCompiler> compiler = std::make_unique<GlslcShaderCompiler>();
 
         // Set to true to compile missing shaders when calling `Finalize()`, and delete unneeded ones.
         bool compile_when_finalized = false;
 
+        // For development. If not empty, `Finalize()` writes the shader sources to this directory (overwriting the old ones), and starts watching them.
+        // Then `ReloadChangedShaders()` recompiles and replaces the shaders whose sources were edited there.
+        // This requires `compile_when_finalized`.
+        std::string hot_reload_dir;
+
         constexpr ShaderManager() {}
         ShaderManager(Gpu::Device &device);
 
@@ -124,6 +168,12 @@ namespace em::Graphics
 
         void Finalize();
 
+        // Call this periodically (e.g. once per frame) after `Finalize()`. Does nothing unless `hot_reload_dir` is set.
+        // Replaces the shaders whose source files were modified, reusing the compiled binaries from `dir` if possible. Returns true if anything was replaced.
+        // `Gpu::Shader` and `Gpu::ComputePipeline` objects are replaced in place, so the pointers to them remain valid. `Gpu::DynamicPipeline`s pick up the new shaders the next time they're used.
+        // If the new source fails to compile, prints the error and keeps the old shader.
+        bool ReloadChangedShaders();
+
         void ProvidedCommandLineFlags(CommandLine::Parser &parser);
     };
 }
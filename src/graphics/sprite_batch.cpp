@@ -0,0 +1,160 @@
+#include "sprite_batch.h"
+
+#include "gpu/refl/vertex_layout.h"
+#include "strings/trim.h"
+
+#include <algorithm>
+#include <array>
+
+namespace em::Graphics
+{
+    namespace
+    {
+        EM_STRUCT( QuadVertex )
+        (
+            // From -0.5 to 0.5 on both axes.
+            (fvec2)(corner)
+        )
+    }
+
+    ShaderProgram SpriteBatch::Resources::shader(
+        "SpriteBatch",
+        (std::string)R"(
+            #version 460
+
+            layout(set = 1, binding = 0) uniform Uni
+            {
+                vec2 u_scr_size;
+            };
+
+            layout(set = 1, binding = 1) uniform UniTex
+            {
+                vec2 u_tex_size;
+            };
+
+            // Per vertex.
+            layout(location = 0) in vec2 a_corner;
+
+            // Per instance.
+            layout(location = 1) in vec2 a_pos;
+            layout(location = 2) in vec2 a_size;
+            layout(location = 3) in vec2 a_tex_pos;
+            layout(location = 4) in vec2 a_tex_size;
+            layout(location = 5) in uvec4 a_color;
+            layout(location = 6) in float a_rotation;
+
+            layout(location = 0) out vec4 v_color;
+            layout(location = 1) out vec2 v_texcoord;
+
+            void main()
+            {
+                vec2 offset = a_corner * a_size;
+                float c = cos(a_rotation);
+                float s = sin(a_rotation);
+                offset = vec2(offset.x * c - offset.y * s, offset.x * s + offset.y * c);
+
+                gl_Position = vec4((a_pos + offset) * 2 / u_scr_size, 0, 1);
+                v_color = vec4(a_color) / 255;
+                v_texcoord = (a_tex_pos + (a_corner + 0.5) * a_tex_size) / u_tex_size;
+            }
+        )"_compact,
+        (std::string)R"(
+            #version 460
+
+            layout(set = 2, binding = 0) uniform sampler2D u_texture;
+
+            layout(location = 0) in vec4 v_color;
+            layout(location = 1) in vec2 v_texcoord;
+
+            layout(location = 0) out vec4 out_color;
+
+            void main()
+            {
+                out_color = texture(u_texture, v_texcoord) * v_color;
+                out_color.rgb *= out_color.a;
+            }
+        )"_compact
+    );
+
+    SpriteBatch::Resources::Resources(Gpu::Device &device, Gpu::CopyPass &copy_pass, const Params &params)
+        : params(params),
+        quad(device, copy_pass, std::array{
+            QuadVertex{fvec2(-0.5f, -0.5f)},
+            QuadVertex{fvec2( 0.5f, -0.5f)},
+            QuadVertex{fvec2(-0.5f,  0.5f)},
+            QuadVertex{fvec2( 0.5f,  0.5f)},
+        }),
+        sprites(device, std::uint32_t(params.num_sprites * sizeof(Sprite))),
+        sampler(device, {.filter_min = Gpu::Sampler::Filter::nearest, .filter_mag = Gpu::Sampler::Filter::nearest}),
+        pipeline(Gpu::Pipeline::Params{
+            .shaders = shader,
+            .vertex_buffers = {
+                Gpu::ReflectedVertexLayout<QuadVertex>{},
+                Gpu::ReflectedVertexLayout<Sprite>{.per_instance = true},
+            },
+            .targets = {.color = {{
+                .blending = Gpu::Pipeline::Blending::Premultiplied(),
+            }}},
+            .primitive = Gpu::Pipeline::Primitive::triangle_strip,
+        })
+    {}
+
+    SpriteBatch::SpriteBatch(Gpu::Device &device, Resources &resources, Gpu::CommandBuffer &render_cmdbuf, Gpu::RenderPass &render_pass, Gpu::CopyPass &copy_pass, SDL_GPUTextureFormat output_format, ivec2 viewport_size)
+    {
+        resources.pipeline.RequestOutputFormat(device, output_format);
+
+        state.resources = &resources;
+        state.render_pass = &render_pass;
+        state.copy_pass = &copy_pass;
+
+        Gpu::Shader::SetUniform(render_cmdbuf, Gpu::Shader::Stage::vertex, 0, fvec2(viewport_size.x, -viewport_size.y)); // Flip the Y component to make the Y axis go down.
+
+        // Try to support having no texture, like `Renderer2d` does.
+        if (state.resources->params.texture)
+            Gpu::Shader::SetUniform(render_cmdbuf, Gpu::Shader::Stage::vertex, 1, state.resources->params.texture->GetSize().to_vec2().to<float>());
+
+        Gpu::Shader::BindTextures(render_pass, {{
+            {.texture = state.resources->params.texture, .sampler = &state.resources->sampler},
+        }});
+
+        state.render_pass->BindPipeline(state.resources->pipeline);
+
+        state.resources->sprites.BeginFrame(device);
+    }
+
+    SpriteBatch::~SpriteBatch()
+    {
+        if (!state.resources)
+            return; // A null instance, do nothing.
+
+        std::uint32_t num_bytes = state.resources->sprites.FinishFrame(*state.copy_pass);
+        if (num_bytes == 0)
+            return;
+
+        // Must bind the instance buffer every time, since the upload cycles it.
+        state.render_pass->BindVertexBuffers({{
+            {.buffer = &state.resources->quad},
+            {.buffer = &state.resources->sprites.GetBuffer()},
+        }});
+
+        state.render_pass->DrawPrimitivesInstanced(4, std::uint32_t(num_bytes / sizeof(Sprite)));
+    }
+
+    void SpriteBatch::DrawSprite(const Sprite &sprite)
+    {
+        AllocateSprites(1).front() = sprite;
+    }
+
+    void SpriteBatch::DrawSprites(std::span<const Sprite> sprites)
+    {
+        if (sprites.empty())
+            return;
+
+        std::ranges::copy(sprites, AllocateSprites(sprites.size()).begin());
+    }
+
+    std::span<SpriteBatch::Sprite> SpriteBatch::AllocateSprites(std::size_t num_sprites)
+    {
+        return state.resources->sprites.AllocateElems<Sprite>(num_sprites);
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "em/math/vector.h"
+#include "em/meta/reset_on_move.h"
+#include "em/refl/macros/structs.h"
+#include "gpu/buffer.h"
+#include "gpu/command_buffer.h"
+#include "gpu/copy_pass.h"
+#include "gpu/device.h"
+#include "gpu/render_pass.h"
+#include "gpu/sampler.h"
+#include "gpu/texture.h"
+#include "graphics/shader_manager.h"
+#include "graphics/streaming_buffer.h"
+
+#include <cstddef>
+#include <span>
+
+namespace em::Graphics
+{
+    // Draws textured sprites using instancing: each sprite is a single small record, expanded to a quad by the vertex shader.
+    // This is much less data per sprite than `Renderer2d`, but can only draw rectangles.
+    // `SpriteBatch` itself needs to be recreated every frame.
+    // `SpriteBatch::Resources` should persist across frames.
+    class SpriteBatch
+    {
+      public:
+        // One of those per sprite. This is the per-instance vertex data.
+        struct Sprite
+        {
+            EM_REFL(
+                // The center of the sprite, in pixels.
+                (fvec2)(pos)
+                // The size in pixels. Negative sizes flip the sprite.
+                (fvec2)(size)
+
+                // The texture region, in texture pixels.
+                (fvec2)(tex_pos)
+                (fvec2)(tex_size)
+
+                // This is multiplied by the texture color. Not premultiplied.
+                (u8vec4)(color)
+
+                // Rotation around `pos`, in radians, clockwise (since the Y axis points down).
+                (float)(rotation)
+            )
+
+            constexpr Sprite() {}
+            constexpr Sprite(fvec2 pos, fvec2 size, fvec2 tex_pos, fvec2 tex_size, u8vec4 color = u8vec4(255, 255, 255, 255), float rotation = 0)
+                : pos(pos), size(size), tex_pos(tex_pos), tex_size(tex_size), color(color), rotation(rotation)
+            {}
+        };
+
+        struct Params
+        {
+            // The initial capacity. If a frame needs more, the storage grows automatically (see `StreamingBuffer`).
+            std::size_t num_sprites = 1024;
+
+            // Not optional. SDL doesn't let you just omit textures if the shader uses them.
+            Gpu::Texture *texture = nullptr;
+        };
+
+        class Resources
+        {
+            friend SpriteBatch;
+
+            EM_REFL(
+                (ShaderProgram)(static shader)
+            )
+
+            Params params;
+
+            // The unit quad that all sprites are made from, as a triangle strip.
+            Gpu::Buffer quad;
+
+            // The sprites of the current frame. All of them are uploaded and drawn at once when the batch is destroyed.
+            StreamingBuffer sprites;
+            Gpu::Sampler sampler;
+
+            Gpu::DynamicPipeline pipeline;
+
+          public:
+            constexpr Resources() {}
+
+            // `copy_pass` is only used for initialization. Finish it before using the batch.
+            Resources(Gpu::Device &device, Gpu::CopyPass &copy_pass, const Params &params);
+        };
+
+      private:
+        struct State
+        {
+            Resources *resources = nullptr;
+            Gpu::RenderPass *render_pass = nullptr;
+            Gpu::CopyPass *copy_pass = nullptr;
+
+            // Need this to make Clang happy in `ResetMovedFromStruct<...>` below.
+            constexpr State() {}
+        };
+        Meta::ResetMovedFromStruct<State> state;
+
+      public:
+        constexpr SpriteBatch() {}
+
+        // The requirements are the same as for `Renderer2d`:
+        // Before calling this, you must have a render command buffer and a copy command buffer, and start render and copy passes on them respectively.
+        // After the destructor runs, you must submit `copy_pass` and then `render_pass`, in this order.
+        // Nothing is drawn until the destructor, which uploads all sprites at once and draws them with a single instanced draw call.
+        // `viewport_size` only affects how the input coordinates are mapped to NDC.
+        SpriteBatch(Gpu::Device &device, Resources &resources, Gpu::CommandBuffer &render_cmdbuf, Gpu::RenderPass &render_pass, Gpu::CopyPass &copy_pass, SDL_GPUTextureFormat output_format, ivec2 viewport_size);
+
+        SpriteBatch(SpriteBatch &&) = default;
+        SpriteBatch &operator=(SpriteBatch &&) = default;
+
+        ~SpriteBatch();
+
+        // How many sprites fit before we have to allocate more memory. This is only informational, exceeding this is fine.
+        [[nodiscard]] std::size_t SpriteCapacity() const {return state.resources->sprites.Capacity() / sizeof(Sprite);}
+
+        // Sprites are drawn in the order they're added.
+        void DrawSprite(const Sprite &sprite);
+        void DrawSprites(std::span<const Sprite> sprites);
+
+        // Allocates space for `num_sprites` sprites, for you to fill. This avoids a copy compared to `DrawSprites()`.
+        // The span is only valid until the next call to any of the drawing functions.
+        [[nodiscard]] std::span<Sprite> AllocateSprites(std::size_t num_sprites);
+    };
+}
@@ -0,0 +1,134 @@
+#include "streaming_buffer.h"
+
+#include "gpu/copy_pass.h"
+#include "gpu/device.h"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <utility>
+
+namespace em::Graphics
+{
+    StreamingBuffer::StreamingBuffer(Gpu::Device &device, std::uint32_t initial_capacity, Gpu::Buffer::Usage usage)
+    {
+        if (initial_capacity == 0)
+            throw std::logic_error("The initial capacity of a `StreamingBuffer` can't be zero.");
+
+        state.usage = usage;
+        state.buffer = Gpu::Buffer(device, initial_capacity, usage);
+        state.buffer_capacity = initial_capacity;
+        state.chunks.push_back({.transfer_buffer = Gpu::TransferBuffer(device, initial_capacity)});
+    }
+
+    std::uint32_t StreamingBuffer::Capacity() const
+    {
+        std::uint32_t ret = 0;
+        for (const Chunk &chunk : state.chunks)
+            ret += chunk.transfer_buffer.Size();
+        return ret;
+    }
+
+    void StreamingBuffer::BeginFrame(Gpu::Device &device)
+    {
+        if (!*this)
+            throw std::logic_error("Attempt to use a null `StreamingBuffer`.");
+        if (IsInFrame())
+            throw std::logic_error("`StreamingBuffer::BeginFrame()` was called twice without `FinishFrame()`.");
+
+        // If the previous frame didn't fit into one chunk, merge all chunks into one.
+        if (state.chunks.size() > 1)
+        {
+            Gpu::TransferBuffer merged(device, Capacity());
+            state.chunks.clear();
+            state.chunks.push_back({.transfer_buffer = std::move(merged)});
+        }
+
+        state.chunks.front().used_bytes = 0;
+
+        state.device = &device;
+        state.cur_chunk = 0;
+        state.cur_chunk_offset_in_buffer = 0;
+    }
+
+    StreamingBuffer::Allocation StreamingBuffer::Allocate(std::uint32_t num_bytes, std::uint32_t alignment)
+    {
+        if (!IsInFrame())
+            throw std::logic_error("`StreamingBuffer::Allocate()` was called outside of a frame.");
+        assert(alignment > 0);
+
+        // How much padding we need to add to make this offset in the GPU buffer aligned.
+        auto PaddingFor = [&](std::uint32_t offset_in_buffer)
+        {
+            return (alignment - offset_in_buffer % alignment) % alignment;
+        };
+
+        Chunk *chunk = &state.chunks[state.cur_chunk];
+        std::uint32_t offset_in_chunk = chunk->used_bytes + PaddingFor(state.cur_chunk_offset_in_buffer + chunk->used_bytes);
+
+        if (offset_in_chunk + num_bytes > chunk->transfer_buffer.Size())
+        {
+            // Doesn't fit, chain a new chunk.
+            // `BeginFrame()` merges the chunks, so there can't be any unused ones after the current one.
+            assert(state.cur_chunk + 1 == state.chunks.size());
+
+            // Make it at least as large as all previous chunks combined, to keep the number of chunks logarithmic.
+            Gpu::TransferBuffer new_transfer_buffer(*state.device, std::max(Capacity(), num_bytes + alignment - 1));
+
+            state.mapping = {};
+            state.cur_chunk_offset_in_buffer += chunk->used_bytes;
+            state.cur_chunk++;
+            chunk = &state.chunks.emplace_back(std::move(new_transfer_buffer));
+
+            offset_in_chunk = PaddingFor(state.cur_chunk_offset_in_buffer);
+        }
+
+        // Map lazily, to avoid cycling the transfer buffer for nothing if the frame is empty.
+        if (!state.mapping)
+            state.mapping = chunk->transfer_buffer.Map(state.cycle);
+
+        chunk->used_bytes = offset_in_chunk + num_bytes;
+
+        return {
+            .bytes = state.mapping.AsRangeOf<char>().subspan(offset_in_chunk, num_bytes),
+            .byte_offset = state.cur_chunk_offset_in_buffer + offset_in_chunk,
+        };
+    }
+
+    std::uint32_t StreamingBuffer::FinishFrame(Gpu::CopyPass &pass)
+    {
+        if (!IsInFrame())
+            throw std::logic_error("`StreamingBuffer::FinishFrame()` was called outside of a frame.");
+
+        // End the frame first, to stay consistent if we throw below.
+        state.mapping = {};
+        Gpu::Device &device = *std::exchange(state.device, nullptr);
+
+        std::uint32_t num_bytes = state.cur_chunk_offset_in_buffer + state.chunks[state.cur_chunk].used_bytes;
+        if (num_bytes == 0)
+            return 0;
+
+        // Grow the GPU buffer if needed.
+        // Make it as large as the merged transfer buffer that the next frame will have, so we don't have to grow it again.
+        if (num_bytes > state.buffer_capacity)
+        {
+            std::uint32_t new_capacity = Capacity();
+            state.buffer = Gpu::Buffer(device, new_capacity, state.usage);
+            state.buffer_capacity = new_capacity;
+        }
+
+        // Upload the chunks back to back. Only cycle on the first upload, otherwise each upload would discard the previous ones.
+        std::uint32_t offset = 0;
+        for (std::size_t i = 0; i <= state.cur_chunk; i++)
+        {
+            Chunk &chunk = state.chunks[i];
+            if (chunk.used_bytes == 0)
+                continue;
+
+            chunk.transfer_buffer.ApplyToBuffer(pass, 0, state.buffer, offset, chunk.used_bytes, /*cycle=*/state.cycle && offset == 0);
+            offset += chunk.used_bytes;
+        }
+
+        return num_bytes;
+    }
+}
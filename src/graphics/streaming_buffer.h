@@ -0,0 +1,127 @@
+#pragma once
+
+#include "em/meta/reset_on_move.h"
+#include "gpu/buffer.h"
+#include "gpu/transfer_buffer.h"
+#include "utils/byte_view.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace em::Gpu
+{
+    class CopyPass;
+    class Device;
+}
+
+namespace em::Graphics
+{
+    // A GPU buffer that's refilled from scratch every frame, in many small pieces.
+    // Everything written during a frame is uploaded at the end of it into one GPU buffer, so you can bind it once and draw everything from it.
+    //
+    // The storage grows as needed. If a frame doesn't fit into the transfer buffer, we chain another one instead of flushing,
+    //   and on the next frame the chain gets merged into a single transfer buffer large enough for the whole previous frame.
+    // Frames in flight are handled by cycling (see `gpu/README-cycling.md`). This happens once per frame: on the first map of the transfer buffer,
+    //   and on the first upload to the GPU buffer.
+    // Cycling can be disabled with `SetCycling(false)`, if you keep one of those per frame in flight (see `Gpu::FrameContext` and `Gpu::PerFrame`).
+    //   Then the memory usage is fixed and predictable, instead of depending on how many copies SDL decides to make.
+    class StreamingBuffer
+    {
+        struct Chunk
+        {
+            Gpu::TransferBuffer transfer_buffer;
+
+            // How many bytes of this chunk are used in the current frame.
+            std::uint32_t used_bytes = 0;
+        };
+
+        struct State
+        {
+            Gpu::Buffer::Usage usage{};
+
+            bool cycle = true;
+
+            Gpu::Buffer buffer;
+            std::uint32_t buffer_capacity = 0;
+
+            // The transfer buffers. Normally there's only one, but more get added if a frame doesn't fit.
+            std::vector<Chunk> chunks;
+
+            // The rest is only used during a frame:
+
+            // We need this to allocate new chunks. Null when not in a frame.
+            Gpu::Device *device = nullptr;
+
+            // Which chunk we're writing to.
+            std::size_t cur_chunk = 0;
+
+            // The mapping of `chunks[cur_chunk]`, if we wrote anything to it yet.
+            Gpu::TransferBuffer::Mapping mapping;
+
+            // The sum of `used_bytes` of the chunks before `cur_chunk`.
+            // This is where the current chunk will land in the GPU buffer.
+            std::uint32_t cur_chunk_offset_in_buffer = 0;
+
+            // Need this to make Clang happy in `ResetMovedFromStruct<...>` below.
+            constexpr State() {}
+        };
+        Meta::ResetMovedFromStruct<State> state;
+
+      public:
+        constexpr StreamingBuffer() {}
+
+        // `initial_capacity` is in bytes.
+        StreamingBuffer(Gpu::Device &device, std::uint32_t initial_capacity, Gpu::Buffer::Usage usage = Gpu::Buffer::Usage::vertex);
+
+        StreamingBuffer(StreamingBuffer &&) = default;
+        StreamingBuffer &operator=(StreamingBuffer &&) = default;
+
+        [[nodiscard]] explicit operator bool() const {return bool(state.buffer);}
+
+        // The buffer you should draw from. Only valid after `FinishFrame()`, and changes when that reallocates it, so don't cache it.
+        [[nodiscard]] Gpu::Buffer &GetBuffer() {return state.buffer;}
+
+        [[nodiscard]] bool IsCycling() const {return state.cycle;}
+        // Only disable this if the GPU is guaranteed to be done with the previous contents by the time you call `BeginFrame()`.
+        void SetCycling(bool enable) {state.cycle = enable;}
+
+        // Is there an unfinished frame?
+        [[nodiscard]] bool IsInFrame() const {return bool(state.device);}
+
+        // The total capacity of all transfer buffers, in bytes. Frames below this size don't allocate anything.
+        [[nodiscard]] std::uint32_t Capacity() const;
+
+        // Starts a new frame, discarding everything written in the previous one.
+        void BeginFrame(Gpu::Device &device);
+
+        // The result of `Allocate()`.
+        struct Allocation
+        {
+            // The memory to write to. Valid until the next `Allocate()` or `FinishFrame()`.
+            mut_byte_view bytes;
+
+            // Where this will be in the GPU buffer.
+            std::uint32_t byte_offset = 0;
+        };
+
+        // Allocates some bytes in the current frame. Never flushes, instead allocates more memory if needed.
+        // `alignment` applies to the offset in the GPU buffer, and doesn't have to be a power of two.
+        [[nodiscard]] Allocation Allocate(std::uint32_t num_bytes, std::uint32_t alignment = 1);
+
+        // A typed wrapper for `Allocate()`. Assuming the GPU buffer is an array of `T`, writes the index of the first allocated element to `first_elem`.
+        template <mut_byte_view_reinterpretable_as_range_of T>
+        [[nodiscard]] std::span<T> AllocateElems(std::size_t num_elems, std::uint32_t *first_elem = nullptr)
+        {
+            Allocation alloc = Allocate(std::uint32_t(num_elems * sizeof(T)), std::uint32_t(sizeof(T)));
+            if (first_elem)
+                *first_elem = std::uint32_t(alloc.byte_offset / sizeof(T));
+            return alloc.bytes.AsRangeOf<T>();
+        }
+
+        // Uploads everything written during this frame to the GPU buffer (reallocating it if it's too small), and ends the frame.
+        // Returns the number of bytes uploaded. After this returns, bind `GetBuffer()` and draw from it.
+        std::uint32_t FinishFrame(Gpu::CopyPass &pass);
+    };
+}
@@ -0,0 +1,202 @@
+#include "texture_atlas.h"
+
+#include "gpu/copy_pass.h"
+#include "gpu/device.h"
+#include "gpu/staging_uploader.h"
+
+#include <fmt/format.h>
+#include <stb_rect_pack.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace em::Graphics
+{
+    struct TextureAtlas::Page
+    {
+        // This must not be moved, because it points to itself. That's why we store pages by pointers.
+        stbrp_context context{};
+        std::vector<stbrp_node> nodes;
+
+        // A copy of the texture contents.
+        mdarray<u8vec4, ivec2> pixels;
+
+        Gpu::Texture texture;
+
+        // The region that needs uploading, see `IsDirty()`.
+        ivec2 dirty_min{};
+        ivec2 dirty_max{};
+
+        Page(ivec2 size)
+            : nodes(std::size_t(size.x)), pixels(size),
+            // The whole page is dirty, to initialize the texture.
+            dirty_max(size)
+        {
+            stbrp_init_target(&context, size.x, size.y, nodes.data(), int(nodes.size()));
+        }
+
+        [[nodiscard]] bool IsDirty() const
+        {
+            return dirty_min.x < dirty_max.x && dirty_min.y < dirty_max.y;
+        }
+
+        void MarkDirty(ivec2 pos, ivec2 size)
+        {
+            if (!IsDirty())
+            {
+                dirty_min = pos;
+                dirty_max = pos + size;
+            }
+            else
+            {
+                dirty_min = ivec2(std::min(dirty_min.x, pos.x), std::min(dirty_min.y, pos.y));
+                dirty_max = ivec2(std::max(dirty_max.x, pos.x + size.x), std::max(dirty_max.y, pos.y + size.y));
+            }
+        }
+    };
+
+    TextureAtlas::TextureAtlas() : TextureAtlas(Params{}) {}
+
+    TextureAtlas::TextureAtlas(const Params &params)
+        : params(params)
+    {
+        if (params.page_size.x <= 0 || params.page_size.y <= 0)
+            throw std::logic_error("The page size of a `TextureAtlas` must be positive.");
+        if (params.padding < 0 || params.extrusion < 0)
+            throw std::logic_error("The padding and the extrusion of a `TextureAtlas` can't be negative.");
+    }
+
+    TextureAtlas::TextureAtlas(TextureAtlas &&) noexcept = default;
+    TextureAtlas &TextureAtlas::operator=(TextureAtlas &&) noexcept = default;
+    TextureAtlas::~TextureAtlas() = default;
+
+    std::vector<TextureAtlas::Region> TextureAtlas::AddImages(std::span<const Image *const> images)
+    {
+        // Each image takes `extrusion` on both sides, and `padding` on one side, which separates it from the next image.
+        const int extra_size = params.extrusion * 2 + params.padding;
+
+        std::vector<stbrp_rect> rects;
+        rects.reserve(images.size());
+        for (std::size_t i = 0; i < images.size(); i++)
+        {
+            // Skip the empty images. They have nothing to draw, and the extrusion below can't clamp to an empty range.
+            if (images[i]->pixels.size().x <= 0 || images[i]->pixels.size().y <= 0)
+                continue;
+
+            ivec2 size = images[i]->pixels.size() + ivec2(extra_size, extra_size);
+            if (size.x > params.page_size.x || size.y > params.page_size.y)
+                throw std::runtime_error(fmt::format("The image is too large for the texture atlas: [{},{}], the page size is [{},{}].", size.x, size.y, params.page_size.x, params.page_size.y));
+
+            rects.push_back({.id = int(i), .w = size.x, .h = size.y});
+        }
+
+        std::vector<Region> ret(images.size());
+
+        // Try the existing pages first, then add new ones until everything fits.
+        std::vector<stbrp_rect> remaining = rects;
+        for (std::size_t page_index = 0; !remaining.empty(); page_index++)
+        {
+            if (page_index == pages.size())
+                pages.push_back(std::make_unique<Page>(params.page_size));
+
+            Page &page = *pages[page_index];
+            stbrp_pack_rects(&page.context, remaining.data(), int(remaining.size()));
+
+            for (const stbrp_rect &rect : remaining)
+            {
+                if (!rect.was_packed)
+                    continue;
+
+                const Image &image = *images[std::size_t(rect.id)];
+                const ivec2 image_size = image.pixels.size();
+                const ivec2 image_pos(rect.x + params.extrusion, rect.y + params.extrusion);
+
+                ret[std::size_t(rect.id)] = {.page = page_index, .pos = image_pos, .size = image_size};
+
+                // Copy the pixels along with the extrusion, by clamping the source coordinates.
+                const ivec2 extruded_pos(rect.x, rect.y);
+                const ivec2 extruded_size = image_size + ivec2(params.extrusion * 2, params.extrusion * 2);
+                for (int y = 0; y < extruded_size.y; y++)
+                for (int x = 0; x < extruded_size.x; x++)
+                {
+                    ivec2 source(std::clamp(x - params.extrusion, 0, image_size.x - 1), std::clamp(y - params.extrusion, 0, image_size.y - 1));
+                    page.pixels[extruded_pos + ivec2(x, y)] = image.pixels[source];
+                }
+
+                page.MarkDirty(extruded_pos, extruded_size);
+            }
+
+            // This always terminates, since we've checked the sizes above, so an empty page can fit at least one of the images.
+            std::erase_if(remaining, [](const stbrp_rect &rect){return bool(rect.was_packed);});
+        }
+
+        return ret;
+    }
+
+    TextureAtlas::Region TextureAtlas::AddImage(const Image &image)
+    {
+        const Image *ptr = &image;
+        return AddImages({&ptr, 1}).front();
+    }
+
+    Gpu::Texture &TextureAtlas::GetTexture(std::size_t page)
+    {
+        return pages.at(page)->texture;
+    }
+
+    const mdarray<u8vec4, ivec2> &TextureAtlas::GetPagePixels(std::size_t page) const
+    {
+        return pages.at(page)->pixels;
+    }
+
+    void TextureAtlas::Upload(Gpu::Device &device, Gpu::CopyPass &copy_pass)
+    {
+        // Put all pages into a single transfer buffer, with some extra space for the alignment padding.
+        std::size_t num_bytes = PendingUploadBytes() + pages.size() * Gpu::StagingUploader::texture_alignment;
+        if (PendingUploadBytes() == 0 && std::all_of(pages.begin(), pages.end(), [](const std::unique_ptr<Page> &page){return bool(page->texture);}))
+            return;
+
+        Gpu::StagingUploader uploader({.chunk_size = std::uint32_t(num_bytes)});
+        Upload(device, uploader);
+        uploader.Flush(copy_pass);
+    }
+
+    void TextureAtlas::Upload(Gpu::Device &device, Gpu::StagingUploader &uploader)
+    {
+        for (const std::unique_ptr<Page> &page : pages)
+        {
+            if (!page->texture)
+                page->texture = Gpu::Texture(device, {.size = params.page_size.to_vec3(1)});
+
+            if (!page->IsDirty())
+                continue; // Nothing to upload.
+
+            // Upload whole rows, since that's a single contiguous range of our pixels.
+            // Then tell SDL to only use the dirty columns from them.
+            const int width = params.page_size.x;
+            std::span<const u8vec4> rows = std::as_const(page->pixels).as_flat_array().subspan(std::size_t(page->dirty_min.y * width), std::size_t((page->dirty_max.y - page->dirty_min.y) * width));
+
+            uploader.UploadToTexture(device, rows, page->texture, {
+                .target_offset = page->dirty_min.to_vec3(0).to<unsigned int>(),
+                .target_size = (page->dirty_max - page->dirty_min).to_vec3(1).to<unsigned int>(),
+                .self_byte_offset = std::uint32_t(page->dirty_min.x * int(sizeof(u8vec4))),
+                .self_size = uvec2(unsigned(width), 0),
+                .cycle = false,
+            });
+
+            page->dirty_min = page->dirty_max = {};
+        }
+    }
+
+    std::size_t TextureAtlas::PendingUploadBytes() const
+    {
+        std::size_t ret = 0;
+        for (const std::unique_ptr<Page> &page : pages)
+        {
+            if (page->IsDirty())
+                ret += std::size_t(page->dirty_max.y - page->dirty_min.y) * std::size_t(params.page_size.x) * sizeof(u8vec4);
+        }
+        return ret;
+    }
+}
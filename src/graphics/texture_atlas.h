@@ -0,0 +1,91 @@
+#pragma once
+
+#include "em/math/vector.h"
+#include "gpu/texture.h"
+#include "utils/image.h"
+#include "utils/mdarray.h"
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace em::Gpu
+{
+    class CopyPass;
+    class StagingUploader;
+    class Device;
+}
+
+namespace em::Graphics
+{
+    // Packs many images into a few large textures ("pages"), using `stb_rect_pack`.
+    // Images can be added at any time. They are packed immediately, and `Upload()` then sends only the modified parts of the pages to the GPU.
+    // A new page is added when an image doesn't fit into the existing ones.
+    class TextureAtlas
+    {
+      public:
+        struct Params
+        {
+            // The size of each texture.
+            ivec2 page_size = ivec2(2048, 2048);
+
+            // The number of empty pixels between the images.
+            int padding = 1;
+
+            // How many times to repeat the edge pixels of each image outwards. This is in addition to `padding`.
+            // This prevents the neighboring images from bleeding into each other with linear filtering.
+            int extrusion = 0;
+        };
+
+        // Where an image ended up.
+        struct Region
+        {
+            // The page index, see `GetTexture()`.
+            std::size_t page = 0;
+
+            // The position and size on the page, in pixels. This excludes the extrusion.
+            // Those are directly usable as `Renderer2d::Vertex::texcoord`, which are in pixels too.
+            ivec2 pos;
+            ivec2 size;
+        };
+
+      private:
+        struct Page;
+
+        Params params;
+        std::vector<std::unique_ptr<Page>> pages;
+
+      public:
+        TextureAtlas();
+        TextureAtlas(const Params &params);
+
+        TextureAtlas(TextureAtlas &&) noexcept;
+        TextureAtlas &operator=(TextureAtlas &&) noexcept;
+        ~TextureAtlas();
+
+        // Packs the images, and returns their positions in the same order.
+        // Packing several images at once gives better results than adding them one by one.
+        // Throws if any of the images is larger than a page (including the padding and the extrusion).
+        // The empty images aren't packed, and get default regions with zero size.
+        [[nodiscard]] std::vector<Region> AddImages(std::span<const Image *const> images);
+        [[nodiscard]] Region AddImage(const Image &image);
+
+        [[nodiscard]] std::size_t NumPages() const {return pages.size();}
+
+        // The texture of a page. This is null until the first `Upload()` after that page is created.
+        [[nodiscard]] Gpu::Texture &GetTexture(std::size_t page);
+
+        // The CPU-side copy of a page. All pages have the size `Params::page_size`.
+        [[nodiscard]] const mdarray<u8vec4, ivec2> &GetPagePixels(std::size_t page) const;
+
+        // Creates the textures for the new pages, and uploads the modified regions of the pages.
+        // Doesn't cycle the textures, since that would discard their old contents. This is fine, since the new images only go to the previously unused areas.
+        void Upload(Gpu::Device &device, Gpu::CopyPass &copy_pass);
+        // Same, but queues the uploads into `uploader`, to be batched with other uploads.
+        void Upload(Gpu::Device &device, Gpu::StagingUploader &uploader);
+
+        // How many bytes the next `Upload()` will send. Pessimistic, includes the pixels outside of the modified regions that share rows with them.
+        [[nodiscard]] std::size_t PendingUploadBytes() const;
+    };
+}
@@ -0,0 +1,9 @@
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+
+#ifdef __GNUC__
+#pragma GCC diagnostic ignored "-Wimplicit-fallthrough"
+#pragma GCC diagnostic ignored "-Wimplicit-int-conversion"
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#endif
+
+#include <stb_image_write.h>
@@ -0,0 +1,8 @@
+#define STB_RECT_PACK_IMPLEMENTATION
+
+#ifdef __GNUC__
+#pragma GCC diagnostic ignored "-Wimplicit-int-conversion"
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#endif
+
+#include <stb_rect_pack.h>
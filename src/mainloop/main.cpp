@@ -1,4 +1,4 @@
-#ifndef EM_ENABLE_TESTS
+#if !defined(EM_ENABLE_TESTS) && !defined(EM_TOOL)
 
 #include "main.h"
 
@@ -39,4 +39,4 @@ void SDL_AppQuit(void *appstate, SDL_AppResult result)
     delete static_cast<em::App::Module *>(appstate);
 }
 
-#endif // EM_ENABLE_TESTS
+#endif // !defined(EM_ENABLE_TESTS) && !defined(EM_TOOL)
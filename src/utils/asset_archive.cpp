@@ -0,0 +1,249 @@
+#include "asset_archive.h"
+
+#include <fmt/format.h>
+#include <stb_image.h>
+
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+// This is from `stb_image_write.h` (see `library_impls/stb_image_write.cpp`). It's not declared in the header part of it, so we declare it ourselves.
+// Returns a zlib stream allocated with `malloc()`.
+extern "C" unsigned char *stbi_zlib_compress(unsigned char *data, int data_len, int *out_len, int quality);
+
+namespace em
+{
+    namespace
+    {
+        // We just `memcpy` the structs to and from the archive.
+        static_assert(std::endian::native == std::endian::little, "The asset archives assume a little-endian CPU.");
+        static_assert(sizeof(AssetArchive::Header) == 32);
+        static_assert(sizeof(AssetArchive::IndexEntry) == 32);
+
+        constexpr std::size_t index_entry_alignment = 8;
+
+        [[nodiscard]] std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment)
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+    }
+
+    AssetArchive::AssetArchive(zstring_view path, Filesystem::FileAccessHint access_hint)
+        : AssetArchive(std::string(path), Filesystem::FileContents(path, nullptr, {.map_min_size = 0, .access_hint = access_hint}))
+    {}
+
+    AssetArchive::AssetArchive(std::string name, blob data)
+    {
+        auto Fail = [&](std::string_view message)
+        {
+            throw std::runtime_error(fmt::format("Invalid asset archive `{}`: {}", name, message));
+        };
+
+        Header header;
+        if (data.size() < sizeof(header))
+            Fail("It's too small to contain a header.");
+        std::memcpy(&header, data.data(), sizeof(header));
+
+        if (std::memcmp(header.magic, Header::expected_magic, sizeof(header.magic)) != 0)
+            Fail("It's not an asset archive.");
+        if (header.version != Header::current_version)
+            Fail(fmt::format("Unsupported version {}, expected {}.", header.version, Header::current_version));
+        if (header.index_offset > data.size() || header.index_size > data.size() - header.index_offset)
+            Fail("The index is out of bounds.");
+
+        // Check this before reserving, so a bogus count can't make us allocate a lot of memory. Each entry takes at least `sizeof(IndexEntry)` bytes.
+        if (header.num_entries > header.index_size / sizeof(IndexEntry))
+            Fail(fmt::format("The index claims {} entries, but is too small to contain that many.", header.num_entries));
+
+        state.entries.reserve(header.num_entries);
+
+        std::uint64_t pos = header.index_offset;
+        const std::uint64_t index_end = header.index_offset + header.index_size;
+
+        for (std::uint32_t i = 0; i < header.num_entries; i++)
+        {
+            IndexEntry entry;
+            if (index_end - pos < sizeof(entry))
+                Fail("The index is truncated.");
+            std::memcpy(&entry, data.data() + pos, sizeof(entry));
+            pos += sizeof(entry);
+
+            if (index_end - pos < entry.name_size)
+                Fail("The index is truncated.");
+            std::string entry_name(reinterpret_cast<const char *>(data.data() + pos), entry.name_size);
+            pos = std::min(AlignUp(pos + entry.name_size, index_entry_alignment), index_end);
+
+            if (entry.byte_offset > data.size() || entry.stored_size > data.size() - entry.byte_offset)
+                Fail(fmt::format("The entry `{}` is out of bounds.", entry_name));
+            if (entry.compression != Compression::none && entry.compression != Compression::zlib)
+                Fail(fmt::format("The entry `{}` uses an unknown compression method {}.", entry_name, std::uint32_t(entry.compression)));
+            if (entry.compression == Compression::none && entry.stored_size != entry.size)
+                Fail(fmt::format("The entry `{}` isn't compressed, but its compressed size doesn't match the original size.", entry_name));
+
+            if (!state.entries.try_emplace(entry_name, entry).second)
+                Fail(fmt::format("Duplicate entry `{}`.", entry_name));
+        }
+
+        state.name = std::move(name);
+        state.data = std::move(data);
+    }
+
+    const AssetArchive::IndexEntry *AssetArchive::FindEntry(std::string_view name) const
+    {
+        auto iter = state.entries.find(name);
+        if (iter == state.entries.end())
+            return nullptr;
+        return &iter->second;
+    }
+
+    std::optional<blob> AssetArchive::TryGet(std::string_view name) const
+    {
+        const IndexEntry *entry = FindEntry(name);
+        if (!entry)
+            return {};
+
+        blob stored = state.data.Slice(std::size_t(entry->byte_offset), std::size_t(entry->stored_size));
+
+        switch (entry->compression)
+        {
+          case Compression::none:
+            return stored;
+
+          case Compression::zlib:
+            {
+                if (entry->size > INT_MAX || entry->stored_size > INT_MAX)
+                    throw std::runtime_error(fmt::format("The asset archive entry `{}` in `{}` is too large to decompress.", name, state.name));
+
+                auto ptr = std::make_shared_for_overwrite<unsigned char[]>(std::size_t(entry->size));
+                int result = stbi_zlib_decode_buffer(reinterpret_cast<char *>(ptr.get()), int(entry->size), reinterpret_cast<const char *>(stored.data()), int(stored.size()));
+                if (result < 0 || std::uint64_t(result) != entry->size)
+                    throw std::runtime_error(fmt::format("Unable to decompress the asset archive entry `{}` in `{}`.", name, state.name));
+
+                return blob(std::move(ptr), std::size_t(entry->size));
+            }
+        }
+
+        // This should be unreachable, the constructor validates the compression methods.
+        throw std::logic_error("Unknown asset archive compression method.");
+    }
+
+    blob AssetArchive::Get(std::string_view name) const
+    {
+        std::optional<blob> ret = TryGet(name);
+        if (!ret)
+            throw std::runtime_error(fmt::format("The asset archive `{}` has no entry named `{}`.", state.name, name));
+        return std::move(*ret);
+    }
+
+    void AssetArchive::VisitEntries(const std::function<void(std::string_view name, const IndexEntry &entry)> &func) const
+    {
+        for (const auto &[name, entry] : state.entries)
+            func(name, entry);
+    }
+
+
+    AssetArchiveWriter::AssetArchiveWriter(const Params &params)
+    {
+        if (params.alignment == 0)
+            throw std::logic_error("The asset archive alignment can't be zero.");
+
+        state.params = params;
+    }
+
+    void AssetArchiveWriter::Add(std::string name, blob data, bool compress)
+    {
+        if (state.names.contains(name))
+            throw std::logic_error(fmt::format("Duplicate asset archive entry `{}`.", name));
+
+        Entry entry;
+        entry.size = data.size();
+
+        if (compress && data.size() > 0)
+        {
+            if (data.size() > INT_MAX)
+                throw std::runtime_error(fmt::format("The asset archive entry `{}` is too large to compress.", name));
+
+            int compressed_size = 0;
+            // `stbi_zlib_compress()` doesn't modify the input, it just lacks `const`. 8 is the compression level it uses for PNGs by default.
+            unsigned char *compressed = stbi_zlib_compress(const_cast<unsigned char *>(data.data()), int(data.size()), &compressed_size, 8);
+            if (!compressed)
+                throw std::runtime_error(fmt::format("Unable to compress the asset archive entry `{}`.", name));
+
+            blob compressed_blob(std::shared_ptr<const unsigned char[]>(compressed, [](const unsigned char *ptr){std::free(const_cast<unsigned char *>(ptr));}), std::size_t(compressed_size));
+
+            // Only keep the compressed version if it's actually smaller.
+            if (compressed_blob.size() < data.size())
+            {
+                data = std::move(compressed_blob);
+                entry.compression = AssetArchive::Compression::zlib;
+            }
+        }
+
+        entry.data = std::move(data);
+        entry.name = name;
+        state.entries.push_back(std::move(entry));
+        state.names.insert(std::move(name));
+    }
+
+    std::vector<unsigned char> AssetArchiveWriter::Serialize() const
+    {
+        std::vector<unsigned char> ret;
+
+        auto AppendBytes = [&](const void *bytes, std::size_t size)
+        {
+            ret.insert(ret.end(), static_cast<const unsigned char *>(bytes), static_cast<const unsigned char *>(bytes) + size);
+        };
+        auto PadTo = [&](std::uint64_t alignment)
+        {
+            ret.resize(std::size_t(AlignUp(ret.size(), alignment)));
+        };
+
+        AssetArchive::Header header;
+        std::memcpy(header.magic, AssetArchive::Header::expected_magic, sizeof(header.magic));
+        header.version = AssetArchive::Header::current_version;
+        header.num_entries = std::uint32_t(state.entries.size());
+        ret.resize(sizeof(header)); // Write the header at the end, when we know the index location.
+
+        std::vector<AssetArchive::IndexEntry> index;
+        index.reserve(state.entries.size());
+
+        for (const Entry &entry : state.entries)
+        {
+            PadTo(state.params.alignment);
+            index.push_back({
+                .byte_offset = ret.size(),
+                .stored_size = entry.data.size(),
+                .size = entry.size,
+                .compression = entry.compression,
+                .name_size = std::uint32_t(entry.name.size()),
+            });
+            AppendBytes(entry.data.data(), entry.data.size());
+        }
+
+        PadTo(index_entry_alignment);
+        header.index_offset = ret.size();
+        for (std::size_t i = 0; i < index.size(); i++)
+        {
+            AppendBytes(&index[i], sizeof(index[i]));
+            AppendBytes(state.entries[i].name.data(), state.entries[i].name.size());
+            PadTo(index_entry_alignment);
+        }
+        header.index_size = ret.size() - header.index_offset;
+
+        std::memcpy(ret.data(), &header, sizeof(header));
+        return ret;
+    }
+
+    void AssetArchiveWriter::Save(zstring_view path) const
+    {
+        std::vector<unsigned char> bytes = Serialize();
+
+        Filesystem::File file(path, "wb");
+        if (std::fwrite(bytes.data(), bytes.size(), 1, file.Handle()) != 1)
+            throw std::runtime_error(fmt::format("Unable to write the asset archive to `{}`.", path));
+    }
+}
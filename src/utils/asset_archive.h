@@ -0,0 +1,166 @@
+#pragma once
+
+#include "em/zstring_view.h"
+#include "utils/blob.h"
+#include "utils/filesystem.h"
+
+#include <gtl/phmap.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace em
+{
+    // A single-file archive of assets, to avoid opening every asset file separately.
+    // Make those with `AssetArchiveWriter`, or with the `asset-packer` tool (see `tools/asset_packer.cpp`).
+    //
+    // The whole archive is memory-mapped when possible (see `Filesystem::FileContents`), and the uncompressed assets are returned
+    //   as views into it, without copying. The compressed ones are decompressed on every `Get()`, so cache them yourself if you need them more than once.
+    // The returned blobs share the ownership of the archive memory, so they can outlive the `AssetArchive` object.
+    //
+    // The format, all integers are little-endian:
+    //   `Header`
+    //   The contents of the files, each aligned to the alignment chosen when writing the archive.
+    //   The index: `Header::num_entries` copies of `IndexEntry`, each followed by the name, padded to a multiple of 8 bytes.
+    class AssetArchive
+    {
+      public:
+        enum class Compression : std::uint32_t
+        {
+            none = 0,
+            zlib = 1,
+        };
+
+        struct Header
+        {
+            static constexpr char expected_magic[8] = {'E', 'M', 'A', 'S', 'S', 'E', 'T', 'S'};
+            static constexpr std::uint32_t current_version = 1;
+
+            char magic[8]{};
+            std::uint32_t version = 0;
+            std::uint32_t num_entries = 0;
+            std::uint64_t index_offset = 0;
+            std::uint64_t index_size = 0;
+        };
+
+        struct IndexEntry
+        {
+            // The offset in the archive.
+            std::uint64_t byte_offset = 0;
+            // The size in the archive, possibly compressed.
+            std::uint64_t stored_size = 0;
+            // The size after decompression.
+            std::uint64_t size = 0;
+            Compression compression = Compression::none;
+            // The name follows this struct.
+            std::uint32_t name_size = 0;
+        };
+
+      private:
+        struct State
+        {
+            // The archive name for the error messages, normally the file path.
+            std::string name;
+
+            blob data;
+
+            // Those point into `data`. The names are relative paths with `/` as the separator.
+            gtl::flat_hash_map<std::string, IndexEntry> entries;
+        };
+        State state;
+
+      public:
+        AssetArchive() {}
+
+        // Opens an archive file. Throws on failure.
+        // Use `FileAccessHint::random` if you're only going to load some of the assets.
+        // This memory-maps the file when possible, but falls back to reading it into memory if it can't be mapped,
+        //   e.g. on Windows, or when the file size is a multiple of the page size (see `Filesystem::FileContents`).
+        explicit AssetArchive(zstring_view path, Filesystem::FileAccessHint access_hint = Filesystem::FileAccessHint::sequential);
+
+        // Uses an archive that's already in memory. `name` is only used in the error messages.
+        AssetArchive(std::string name, blob data);
+
+        AssetArchive(AssetArchive &&other) noexcept
+            : state(std::move(other.state))
+        {
+            other.state = {};
+        }
+        AssetArchive &operator=(AssetArchive other) noexcept
+        {
+            std::swap(state, other.state);
+            return *this;
+        }
+
+        // Every valid archive at least has a header, so this is true for all non-null archives.
+        [[nodiscard]] explicit operator bool() const {return state.data.size() > 0;}
+
+        [[nodiscard]] const std::string &GetName() const {return state.name;}
+
+        [[nodiscard]] std::size_t NumEntries() const {return state.entries.size();}
+
+        // Returns null if there's no such entry.
+        [[nodiscard]] const IndexEntry *FindEntry(std::string_view name) const;
+        [[nodiscard]] bool Contains(std::string_view name) const {return FindEntry(name);}
+
+        // Returns the contents of an entry, or null if there's no such entry. Throws if the entry can't be decompressed.
+        [[nodiscard]] std::optional<blob> TryGet(std::string_view name) const;
+        // Same, but throws if there's no such entry.
+        [[nodiscard]] blob Get(std::string_view name) const;
+
+        // Calls `func` for every entry, in no particular order.
+        void VisitEntries(const std::function<void(std::string_view name, const IndexEntry &entry)> &func) const;
+    };
+
+    // Builds `AssetArchive`s.
+    class AssetArchiveWriter
+    {
+      public:
+        struct Params
+        {
+            // The alignment of every file in the archive, relative to its start.
+            // 16 is enough for anything the CPU is going to read, but you can use the page size if you want every file to start on its own page.
+            std::uint32_t alignment = 16;
+        };
+
+      private:
+        struct Entry
+        {
+            std::string name;
+            // Possibly compressed.
+            blob data;
+            AssetArchive::Compression compression = AssetArchive::Compression::none;
+            std::uint64_t size = 0;
+        };
+
+        struct State
+        {
+            Params params;
+            std::vector<Entry> entries;
+            gtl::flat_hash_set<std::string> names;
+        };
+        State state;
+
+      public:
+        AssetArchiveWriter() : AssetArchiveWriter(Params{}) {}
+        explicit AssetArchiveWriter(const Params &params);
+
+        // Adds a file. The names must be unique. Use relative paths with `/` as the separator.
+        // If `compress` is true, compresses the data, unless that doesn't make it smaller. Don't bother for already compressed formats, such as PNG.
+        void Add(std::string name, blob data, bool compress = false);
+
+        [[nodiscard]] std::size_t NumEntries() const {return state.entries.size();}
+
+        // Produces the archive in memory.
+        [[nodiscard]] std::vector<unsigned char> Serialize() const;
+
+        // Writes the archive to a file. Throws on failure.
+        void Save(zstring_view path) const;
+    };
+}
@@ -0,0 +1,45 @@
+#include "utils/asset_archive.h"
+
+#include "em/minitest.hpp"
+
+#include <string>
+
+using namespace em;
+
+EM_TEST( asset_archive_round_trip )
+{
+    const std::string compressible(1000, 'x');
+
+    AssetArchiveWriter writer({.alignment = 64});
+    writer.Add("a.txt", blob(blob::NonOwning{}, std::string_view("hello")));
+    writer.Add("dir/b.txt", blob(blob::NonOwning{}, std::string_view(compressible)), true);
+    writer.Add("empty", blob(blob::NonOwning{}, std::string_view()), true);
+    EM_MUST_THROW( writer.Add("a.txt", blob()) )(std::logic_error("Duplicate asset archive entry `a.txt`."));
+
+    std::vector<unsigned char> bytes = writer.Serialize();
+    AssetArchive archive("test", blob(blob::NonOwning{}, const_byte_view(bytes)));
+
+    EM_CHECK_SOFT(archive.NumEntries() == 3);
+
+    EM_CHECK_SOFT(std::string_view(archive.Get("a.txt")) == "hello");
+    EM_CHECK_SOFT(archive.FindEntry("a.txt")->byte_offset % 64 == 0);
+    EM_CHECK_SOFT(archive.FindEntry("a.txt")->compression == AssetArchive::Compression::none);
+
+    EM_CHECK_SOFT(std::string_view(archive.Get("dir/b.txt")) == compressible);
+    EM_CHECK_SOFT(archive.FindEntry("dir/b.txt")->compression == AssetArchive::Compression::zlib);
+    EM_CHECK_SOFT(archive.FindEntry("dir/b.txt")->stored_size < compressible.size());
+
+    EM_CHECK_SOFT(archive.Get("empty").size() == 0);
+
+    EM_CHECK_SOFT(!archive.TryGet("missing"));
+    EM_MUST_THROW( (void)archive.Get("missing") )(std::runtime_error("The asset archive `test` has no entry named `missing`."));
+}
+
+EM_TEST( asset_archive_invalid )
+{
+    EM_MUST_THROW( AssetArchive("test", blob(blob::NonOwning{}, std::string_view("foo"))) )(std::runtime_error("Invalid asset archive `test`: It's too small to contain a header."));
+
+    std::vector<unsigned char> bytes = AssetArchiveWriter().Serialize();
+    bytes[0] = 'X';
+    EM_MUST_THROW( AssetArchive("test", blob(blob::NonOwning{}, const_byte_view(bytes))) )(std::runtime_error("Invalid asset archive `test`: It's not an asset archive."));
+}
@@ -10,6 +10,7 @@
 #include <cstring>
 #include <memory>
 #include <span>
+#include <stdexcept>
 #include <type_traits>
 #include <vector>
 
@@ -116,6 +117,16 @@ namespace em
             return zblob(std::move(ptr), size());
         }
 
+        // Returns a part of this blob, sharing the ownership with it. Doesn't copy the data.
+        // The result isn't null-terminated, since the slice can end anywhere. Throws if the slice is out of bounds.
+        [[nodiscard]] blob Slice(std::size_t offset, std::size_t slice_size) const
+        {
+            // Written this way to avoid overflowing on `offset + slice_size`.
+            if (offset > size() || slice_size > size() - offset)
+                throw std::out_of_range("The blob slice is out of bounds.");
+            return blob(std::shared_ptr<const unsigned char[]>(ptr, ptr.get() + offset), slice_size);
+        }
+
         [[nodiscard]] const unsigned char *data() const {return ptr.get();}
         [[nodiscard]] const unsigned char *c_str() const requires IsNullTerminated {return ptr.get();}
 
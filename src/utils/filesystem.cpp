@@ -9,6 +9,11 @@
 #define MOMINMAX
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
 namespace em::Filesystem
@@ -149,11 +154,74 @@ namespace em::Filesystem
     }
     #endif
 
-    FileContents::FileContents(zstring_view file_path, bool *success)
+    #ifndef _WIN32
+    namespace
+    {
+        // Tries to memory-map the file. Returns null if the file should be read normally instead, either because it's too small,
+        //   or because the mapping failed. The caller then reports the errors, if any, when trying to read it.
+        [[nodiscard]] std::optional<zblob> TryMapFile(zstring_view file_path, const FileLoadParams &params)
+        {
+            int fd = open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd == -1)
+                return {};
+
+            struct stat file_stat{};
+            bool ok = fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode);
+            const std::uint64_t size = ok ? std::uint64_t(file_stat.st_size) : 0;
+
+            // `zblob` must be null-terminated. The mapped memory after the end of the file is zeroed up to the end of the page,
+            //   so we get the null-terminator for free, unless the size is a multiple of the page size. Then we read the file normally.
+            // Empty files can't be mapped at all.
+            static const std::uint64_t page_size = std::uint64_t(sysconf(_SC_PAGESIZE));
+            ok = ok && size > 0 && size >= params.map_min_size && size % page_size != 0 && size <= std::numeric_limits<std::size_t>::max();
+
+            void *ptr = ok ? mmap(nullptr, std::size_t(size), PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+
+            // The mapping stays valid after closing the file.
+            close(fd);
+
+            if (ptr == MAP_FAILED)
+                return {};
+
+            switch (params.access_hint)
+            {
+              case FileAccessHint::normal:
+                break;
+              case FileAccessHint::sequential:
+                (void)madvise(ptr, std::size_t(size), MADV_SEQUENTIAL); // This is only a hint, so ignore the errors.
+                break;
+              case FileAccessHint::random:
+                (void)madvise(ptr, std::size_t(size), MADV_RANDOM);
+                break;
+            }
+
+            return zblob(
+                std::shared_ptr<const unsigned char[]>(
+                    reinterpret_cast<const unsigned char *>(ptr),
+                    [size](const unsigned char *data){munmap(const_cast<unsigned char *>(data), std::size_t(size));}
+                ),
+                std::size_t(size)
+            );
+        }
+    }
+    #endif
+
+    FileContents::FileContents(zstring_view file_path, bool *success, const FileLoadParams &params)
     {
         if (success)
             *success = true;
 
+        #ifndef _WIN32
+        if (std::optional<zblob> mapped = TryMapFile(file_path, params))
+        {
+            zblob::operator=(std::move(*mapped));
+            is_mapped = true;
+            return;
+        }
+        #else
+        (void)params; // Memory-mapping isn't implemented on Windows yet.
+        #endif
+
         std::size_t size = 0;
         auto new_ptr = reinterpret_cast<const unsigned char *>(SDL_LoadFile(file_path.c_str(), &size));
         if (!new_ptr)
@@ -7,6 +7,7 @@
 #include <cstdint>
 #include <cstdio>
 #include <functional>
+#include <limits>
 #include <string_view>
 #include <utility>
 #ifdef _WIN32
@@ -81,20 +82,48 @@ namespace em::Filesystem
     };
 
 
+    // How the file is going to be read, for memory-mapped files. This tells the OS how to prefetch the pages.
+    enum class FileAccessHint
+    {
+        normal,
+        sequential, // Read from start to end, e.g. when decoding images. Prefetches aggressively and drops the pages behind.
+        random, // Jump around, e.g. when reading individual assets from an archive. Disables prefetching.
+    };
+
+    struct FileLoadParams
+    {
+        // Memory-map the files at least this large, instead of reading them to the heap. This only happens on the platforms that support it (not on Windows yet).
+        // The mapped pages are shared with the OS page cache, so this avoids a copy, and only the parts you actually touch are read from the disk.
+        // But the file must not be truncated while it's mapped (that crashes on access), so don't map the files that can be edited at runtime.
+        std::uint64_t map_min_size = 256 << 10;
+
+        // Only matters for memory-mapped files.
+        FileAccessHint access_hint = FileAccessHint::sequential;
+
+        // Disables memory-mapping.
+        [[nodiscard]] static constexpr FileLoadParams NeverMap() {return {.map_min_size = std::numeric_limits<std::uint64_t>::max()};}
+    };
+
     // The contents of a file loaded to memory.
+    // This is either read to the heap, or memory-mapped, see `FileLoadParams`. You normally don't need to care which one.
     class FileContents : public zblob
     {
         // A file name for the user.
         Meta::ZeroMovedFrom<std::string> name;
 
+        bool is_mapped = false;
+
       public:
         [[nodiscard]] constexpr FileContents() {}
 
         // Load from a file.
         // If `success` isn't null, on failure sets it to false (otherwise to true), instead of throwing an exception.
-        [[nodiscard]] FileContents(zstring_view file_path, bool *success = nullptr);
+        [[nodiscard]] FileContents(zstring_view file_path, bool *success = nullptr, const FileLoadParams &params = {});
 
         [[nodiscard]] const std::string &GetName() const {return name.value;}
+
+        // Returns true if the file was memory-mapped instead of being read.
+        [[nodiscard]] bool IsMapped() const {return is_mapped;}
     };
 
 
@@ -162,6 +191,11 @@ namespace em
             : basic_blob<IsNullTerminated>(Filesystem::FileContents(file_path, success))
         {}
 
+        // Load from a file with custom parameters.
+        [[nodiscard]] basic_blob_or_file(zstring_view file_path, const Filesystem::FileLoadParams &params, bool *success = nullptr)
+            : basic_blob<IsNullTerminated>(Filesystem::FileContents(file_path, success, params))
+        {}
+
         // Convert from a regular `[z]blob`.
         // The `zblob` to `blob_or_file` convesion is handled automatically by an inherited constructor, we don't need to do it here.
         [[nodiscard]] basic_blob_or_file(basic_blob<IsNullTerminated> other) : basic_blob<IsNullTerminated>(std::move(other)) {}
@@ -1,21 +1,187 @@
 #include "image.h"
 
+#include "utils/thread_pool.h"
+
 #include <fmt/format.h>
 #include <stb_image.h>
 
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <latch>
+#include <stdexcept>
+
 namespace em
 {
-    void Image::StbiDeleter::operator()(u8vec4 *ptr)
+    namespace
+    {
+        constexpr char raw_magic[8] = {'E', 'M', 'R', 'A', 'W', 'I', 'M', 'G'};
+        constexpr std::size_t raw_header_size = sizeof(raw_magic) + sizeof(std::uint32_t) * 2;
+
+        static_assert(std::endian::native == std::endian::little, "The raw image format assumes a little-endian CPU.");
+        static_assert(sizeof(u8vec4) == 4);
+
+        [[nodiscard]] bool RawMatches(const_byte_view data)
+        {
+            return data.size() >= raw_header_size && std::memcmp(data.data(), raw_magic, sizeof(raw_magic)) == 0;
+        }
+
+        [[nodiscard]] Image RawDecode(const_byte_view data)
+        {
+            std::uint32_t w = 0, h = 0;
+            std::memcpy(&w, data.data() + sizeof(raw_magic), sizeof(w));
+            std::memcpy(&h, data.data() + sizeof(raw_magic) + sizeof(w), sizeof(h));
+
+            if (w > 0x8000 || h > 0x8000) // Sanity check, to avoid overflows below.
+                throw std::runtime_error(fmt::format("The raw image size {}x{} is too large.", w, h));
+            if (data.size() - raw_header_size != std::size_t(w) * h * sizeof(u8vec4))
+                throw std::runtime_error("The raw image size doesn't match the amount of pixel data.");
+
+            Image ret(ivec2(int(w), int(h)));
+            std::memcpy(ret.pixels.as_flat_array().data(), data.data() + raw_header_size, data.size() - raw_header_size);
+            return ret;
+        }
+
+        [[nodiscard]] bool StbMatches(const_byte_view data)
+        {
+            (void)data;
+            return true; // This is the fallback, let it figure out the format on its own.
+        }
+
+        [[nodiscard]] Image StbDecode(const_byte_view data)
+        {
+            ivec2 size;
+            auto *ptr = reinterpret_cast<u8vec4 *>(stbi_load_from_memory(reinterpret_cast<const stbi_uc *>(data.data()), int(data.size()), &size.x, &size.y, nullptr, 4));
+            if (!ptr)
+                throw std::runtime_error(fmt::format("stb_image error: {}", stbi_failure_reason()));
+            return Image(size, ptr, [](u8vec4 *ptr){stbi_image_free(ptr);});
+        }
+
+        [[nodiscard]] std::vector<Image::Decoder> &Decoders()
+        {
+            // The last one is tried first.
+            static std::vector<Image::Decoder> ret = {
+                {.name = "stb_image", .matches = StbMatches, .decode = StbDecode},
+                {.name = "raw", .matches = RawMatches, .decode = RawDecode},
+            };
+            return ret;
+        }
+    }
+
+    Image::Image(ivec2 size)
     {
-        stbi_image_free(ptr);
+        if (size.x < 0 || size.y < 0)
+            throw std::logic_error("Image size can't be negative.");
+
+        *this = Image(size, new u8vec4[std::size_t(size.x) * std::size_t(size.y)], [](u8vec4 *ptr){delete[] ptr;});
     }
 
+    Image::Image(ivec2 size, u8vec4 *pixels_ptr, void (*free_func)(u8vec4 *ptr))
+        : pixels(unsafe_mdarray_from_container{}, size, PixelsUniquePtr(pixels_ptr, PixelsDeleter{.free_func = free_func}))
+    {}
+
     Image::Image(std::string_view name, const blob_or_file &data)
     {
-        ivec2 size;
-        StbiUniquePtr u(reinterpret_cast<u8vec4 *>(stbi_load_from_memory(reinterpret_cast<const stbi_uc *>(data.data()), int(data.size()), &size.x, &size.y, nullptr, 4)));
-        if (!u)
-            throw std::runtime_error(fmt::format("Failed to parse image: `{}`.", name));
-        pixels = pixels_type(unsafe_mdarray_from_container{}, size, std::move(u));
+        std::vector<Decoder> &decoders = Decoders();
+        for (auto it = decoders.rbegin(); it != decoders.rend(); ++it)
+        {
+            if (!it->matches(data))
+                continue;
+
+            try
+            {
+                *this = it->decode(data);
+                return;
+            }
+            catch (...)
+            {
+                std::throw_with_nested(std::runtime_error(fmt::format("Failed to parse image: `{}` (using the `{}` decoder).", name, it->name)));
+            }
+        }
+
+        throw std::runtime_error(fmt::format("Failed to parse image: `{}`. Unknown format.", name));
+    }
+
+    void Image::AddDecoder(const Decoder &decoder)
+    {
+        Decoders().push_back(decoder);
+    }
+
+    std::vector<unsigned char> Image::EncodeRaw() const
+    {
+        const std::uint32_t w = std::uint32_t(pixels.size().x);
+        const std::uint32_t h = std::uint32_t(pixels.size().y);
+        const std::span<const u8vec4> flat = pixels.as_flat_array();
+
+        std::vector<unsigned char> ret(raw_header_size + flat.size_bytes());
+        std::memcpy(ret.data(), raw_magic, sizeof(raw_magic));
+        std::memcpy(ret.data() + sizeof(raw_magic), &w, sizeof(w));
+        std::memcpy(ret.data() + sizeof(raw_magic) + sizeof(w), &h, sizeof(h));
+        if (!flat.empty())
+            std::memcpy(ret.data() + raw_header_size, flat.data(), flat.size_bytes());
+        return ret;
+    }
+
+    std::vector<Image> LoadImagesInParallel(std::span<const std::string> paths, ThreadPool *thread_pool)
+    {
+        ThreadPool own_thread_pool;
+        if (!thread_pool)
+        {
+            own_thread_pool = ThreadPool(0);
+            thread_pool = &own_thread_pool;
+        }
+
+        std::vector<Image> ret(paths.size());
+
+        // Waiting for the pool from its own thread could deadlock, if all the other threads are busy too.
+        if (thread_pool->IsCurrentThreadInPool())
+        {
+            for (std::size_t i = 0; i < paths.size(); i++)
+                ret[i] = Image(paths[i], blob_or_file(paths[i]));
+            return ret;
+        }
+
+        std::vector<std::exception_ptr> exceptions(paths.size());
+
+        // Not using `ThreadPool::WaitUntilIdle()`, since the pool can be running unrelated tasks.
+        std::latch done(std::ptrdiff_t(paths.size()));
+
+        std::size_t num_queued = 0;
+        try
+        {
+            for (; num_queued < paths.size(); num_queued++)
+            {
+                thread_pool->Run([&, i = num_queued]
+                {
+                    try
+                    {
+                        ret[i] = Image(paths[i], blob_or_file(paths[i]));
+                    }
+                    catch (...)
+                    {
+                        exceptions[i] = std::current_exception();
+                    }
+                    done.count_down();
+                });
+            }
+        }
+        catch (...)
+        {
+            // The tasks that did get queued refer to our local variables, so wait for them before throwing.
+            done.count_down(std::ptrdiff_t(paths.size() - num_queued));
+            done.wait();
+            throw;
+        }
+
+        done.wait();
+
+        for (const std::exception_ptr &e : exceptions)
+        {
+            if (e)
+                std::rethrow_exception(e);
+        }
+
+        return ret;
     }
 }
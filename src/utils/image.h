@@ -1,32 +1,78 @@
 #pragma once
 
 #include "em/math/vector.h"
+#include "utils/byte_view.h"
 #include "utils/filesystem.h"
 #include "utils/mdarray.h"
 
+#include <memory>
+#include <span>
+#include <string>
 #include <string_view>
+#include <vector>
 
 // This file is in `utils/` rather than `graphics/`, because `gpu/` depends on it.
 
 namespace em
 {
+    class ThreadPool;
+
     class Image
     {
-        struct StbiDeleter
+        // The pixels can come from different decoders that allocate them differently, so the deleter is customizable.
+        struct PixelsDeleter
         {
-            void operator()(u8vec4 *ptr);
+            void (*free_func)(u8vec4 *ptr) = nullptr;
+
+            void operator()(u8vec4 *ptr) const {free_func(ptr);}
         };
-        using StbiUniquePtr = std::unique_ptr<u8vec4[], StbiDeleter>;
+        using PixelsUniquePtr = std::unique_ptr<u8vec4[], PixelsDeleter>;
 
       public:
-        using pixels_type = basic_mdarray<StbiUniquePtr, ivec2>;
+        using pixels_type = basic_mdarray<PixelsUniquePtr, ivec2>;
 
         pixels_type pixels;
 
         constexpr Image() {}
 
+        // Makes an image of this size with uninitialized pixels.
+        explicit Image(ivec2 size);
+
+        // Takes ownership of the pixels allocated elsewhere (e.g. by a decoding library), which will be freed with `free_func`.
+        Image(ivec2 size, u8vec4 *pixels_ptr, void (*free_func)(u8vec4 *ptr));
+
         // Loads the image from a blob (that can use the common file formats, such as PNG).
-        // Throws on failure.
+        // The format is detected from the contents, see `Decoder`. Throws on failure.
         Image(std::string_view name, const blob_or_file &data);
+
+
+        // A decoder for one image format.
+        struct Decoder
+        {
+            // For the error messages.
+            std::string name;
+
+            // Returns true if the data looks like this format. This should only check the header.
+            bool (*matches)(const_byte_view data) = nullptr;
+
+            // Decodes the image. Throws on failure.
+            Image (*decode)(const_byte_view data) = nullptr;
+        };
+
+        // Registers a decoder. It's tried before the existing ones.
+        // The built-in decoders are the raw format (see `EncodeRaw()`), and then stb_image for everything else.
+        // This isn't thread-safe. Call this at startup, before decoding anything.
+        static void AddDecoder(const Decoder &decoder);
+
+
+        // Encodes the image in the raw format: "EMRAWIMG", the width and the height as 32-bit little-endian integers, then the RGBA8 pixels.
+        // Decoding this is just a copy, so it's much faster than PNG. Use this for the assets that must load fast,
+        //   and let `AssetArchive` compress them if you care about the size.
+        [[nodiscard]] std::vector<unsigned char> EncodeRaw() const;
     };
+
+    // Loads and decodes several image files at once, one per worker thread. Throws the first error, if any.
+    // If `thread_pool` is null, creates a temporary one with a thread per CPU core.
+    // If this is called from a worker thread of `thread_pool`, decodes everything on the current thread, since waiting for the pool would deadlock.
+    [[nodiscard]] std::vector<Image> LoadImagesInParallel(std::span<const std::string> paths, ThreadPool *thread_pool = nullptr);
 }
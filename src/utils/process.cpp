@@ -10,6 +10,13 @@
 
 #include <vector>
 
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace em
 {
     int Process::NumCpuCores()
@@ -69,11 +76,14 @@ namespace em
                 SDL_CloseIO(state.input_stream);
                 state.input_stream = nullptr;
                 state.input_callback = {};
+                state.input_stream_full = false;
                 return;
             }
 
-            // Stop for now if the pipe doesn't accept any more data.
-            if (stream_is_full)
+            state.input_stream_full = stream_is_full;
+
+            // Stop for now if the pipe doesn't accept any more data, or if the callback has nothing to write at the moment.
+            if (stream_is_full || !callback_had_data)
                 break;
         }
     }
@@ -133,8 +143,8 @@ namespace em
                 if (!state.input_stream && !state.output_stream)
                     break;
 
-                // Same as what `SDL_LoadFile_IO()` uses. Weird that we don't have proper blocking.
-                SDL_Delay(1);
+                Process *self = this;
+                WaitForActivity({&self, 1});
             }
         }
 
@@ -143,6 +153,79 @@ namespace em
             state.exit_code = exit_code;
     }
 
+    void Process::WaitForActivity(std::span<Process *const> processes)
+    {
+        #ifdef __linux__
+        // Returns -1 if the stream has no file descriptor.
+        auto GetStreamFd = [](SDL_IOStream *stream) -> int
+        {
+            return SdlProperties(SdlProperties::ViewExternalHandle{}, SDL_GetIOProperties(stream)).Get<int>(SDL_PROP_IOSTREAM_FILE_DESCRIPTOR_NUMBER, -1);
+        };
+
+        std::vector<pollfd> fds;
+        bool any_running = false;
+        // If we fail to get any of the file descriptors (or have nothing to wait on for some stream), we can't rely on `poll()` to wake us up, and fall back to a short timeout.
+        bool need_timeout = false;
+
+        auto AddFd = [&](int fd, short events)
+        {
+            if (fd < 0)
+                need_timeout = true;
+            else
+                fds.push_back({.fd = fd, .events = events, .revents = 0});
+        };
+
+        for (Process *process : processes)
+        {
+            if (!process || !*process || process->KnownToBeFinished())
+                continue;
+
+            any_running = true;
+            State &process_state = process->state;
+
+            // An empty pipe is always writable, so waiting for `POLLOUT` only makes sense if we have data that didn't fit.
+            // Otherwise the callback can produce more input at any moment, and we can't wait for that, so we fall back to the timeout.
+            if (process_state.input_stream)
+            {
+                if (process_state.input_stream_full)
+                    AddFd(GetStreamFd(process_state.input_stream), POLLOUT);
+                else
+                    need_timeout = true;
+            }
+            if (process_state.output_stream)
+                AddFd(GetStreamFd(process_state.output_stream), POLLIN);
+
+            // The process can't be reaped until we call `SDL_WaitProcess()` on it, and then it's known to be finished and we don't get here.
+            // So the PID can't be reused at this point.
+            if (!process_state.tried_opening_pidfd)
+            {
+                process_state.tried_opening_pidfd = true;
+                #ifdef SYS_pidfd_open
+                pid_t pid = SdlProperties(SdlProperties::ViewExternalHandle{}, SDL_GetProcessProperties(process_state.handle)).Get<pid_t>(SDL_PROP_PROCESS_PID_NUMBER, 0);
+                if (pid > 0)
+                    process_state.pidfd = int(syscall(SYS_pidfd_open, pid, 0)); // Returns -1 on failure, e.g. on old kernels.
+                #endif
+            }
+            AddFd(process_state.pidfd, POLLIN);
+        }
+
+        if (!any_running)
+            return;
+
+        // Retry if interrupted by a signal. Other errors are ignored, since the callers recheck the processes anyway.
+        while (poll(fds.data(), nfds_t(fds.size()), need_timeout ? 1 : -1) < 0 && errno == EINTR) {}
+        #else
+        for (Process *process : processes)
+        {
+            if (process && *process && !process->KnownToBeFinished())
+            {
+                SDL_Delay(1);
+                return;
+            }
+        }
+        #endif
+    }
+
     Process::Process(const char *const *argv, Params params)
         : Process() // Clean up on throw, just in case.
     {
@@ -270,6 +353,11 @@ namespace em
     {
         if (state.handle)
         {
+            #ifdef __linux__
+            if (state.pidfd >= 0)
+                close(state.pidfd);
+            #endif
+
             SDL_DestroyProcess(state.handle);
             state = {};
         }
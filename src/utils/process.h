@@ -9,6 +9,7 @@
 #include <functional>
 #include <initializer_list>
 #include <memory>
+#include <span>
 #include <string_view>
 #include <string>
 
@@ -84,10 +85,18 @@ namespace em
             // Those two are null if we didn't redirect input.
             SDL_IOStream *input_stream = nullptr;
             InputCallback input_callback;
+            // Whether the last `WriteMoreInput()` stopped because the pipe was full. Only then it makes sense to wait for it to become writable.
+            bool input_stream_full = false;
 
             // Those two are null if we didn't redirect output.
             SDL_IOStream *output_stream = nullptr;
             OutputCallback output_callback;
+
+            // Linux only. A file descriptor that becomes readable when the process exits, or -1 if not opened yet.
+            // This is opened lazily by `WaitForActivity()`.
+            int pidfd = -1;
+            // Whether we tried to open `pidfd`. If that failed, we don't try again, and fall back to the timeouts.
+            bool tried_opening_pidfd = false;
         };
         State state;
 
@@ -153,8 +162,16 @@ namespace em
 
 
         // Blocks until the process finishes.
+        // The callbacks are called as the process consumes input and produces output, same as with `CheckIfFinished()`.
         void WaitUntilFinished() {CheckOrWait(true);}
 
+        // Blocks until any of the `processes` has new output, can accept more input, or exits.
+        // This doesn't update their state or call the callbacks, call `CheckIfFinished()` after this.
+        // On Linux this sleeps until one of those things actually happens. On other platforms (or if we can't get the file descriptors),
+        //   this just sleeps for a millisecond, same as `SDL_LoadFile_IO()` does when reading from a pipe.
+        // Null and finished processes are ignored. If there are no other processes, returns immediately.
+        static void WaitForActivity(std::span<Process *const> processes);
+
         // Checks the current process state, returns true if it has finished.
         [[nodiscard]] bool CheckIfFinished() {CheckOrWait(false); return KnownToBeFinished();}
 
@@ -1,5 +1,4 @@
 #include "process_queue.h"
-#include "SDL3/SDL_timer.h"
 #include "utils/terminal.h"
 
 #include <fmt/format.h>
@@ -38,6 +37,9 @@ namespace em
         if (LastKnownStatus().IsFinished())
             return; // Nothing to do.
 
+        // The processes for `Process::WaitForActivity()`.
+        std::vector<Process *> processes;
+
         while (true)
         {
             for (std::size_t i = 0; i < state.jobs.size();)
@@ -109,7 +111,11 @@ namespace em
                 if (state.jobs.empty())
                     break;
 
-                SDL_Delay(1);
+                // Sleep until any of the jobs has something for us, instead of polling them in a loop.
+                processes.clear();
+                for (Job &job : state.jobs)
+                    processes.push_back(&job.process);
+                Process::WaitForActivity(processes);
             }
             else
                 break;
@@ -0,0 +1,100 @@
+#include "range_allocator.h"
+
+#include <fmt/format.h>
+
+#include <stdexcept>
+
+namespace em
+{
+    void RangeAllocator::AddFreeRange(std::uint32_t offset, std::uint32_t size)
+    {
+        if (size == 0)
+            return;
+
+        // Merge with the next range.
+        auto next = state.free_by_offset.lower_bound(offset);
+        if (next != state.free_by_offset.end() && next->first == offset + size)
+        {
+            size += next->second;
+            next = std::next(next);
+            RemoveFreeRange(std::prev(next));
+        }
+
+        // Merge with the previous range.
+        if (next != state.free_by_offset.begin())
+        {
+            auto prev = std::prev(next);
+            if (prev->first + prev->second == offset)
+            {
+                offset = prev->first;
+                size += prev->second;
+                RemoveFreeRange(prev);
+            }
+        }
+
+        state.free_by_offset.try_emplace(offset, size);
+        state.free_by_size.emplace(size, offset);
+    }
+
+    void RangeAllocator::RemoveFreeRange(std::map<std::uint32_t, std::uint32_t>::iterator iter)
+    {
+        state.free_by_size.erase({iter->second, iter->first});
+        state.free_by_offset.erase(iter);
+    }
+
+    RangeAllocator::RangeAllocator(std::uint32_t capacity)
+    {
+        state.capacity = capacity;
+        AddFreeRange(0, capacity);
+    }
+
+    std::optional<std::uint32_t> RangeAllocator::Allocate(std::uint32_t size, std::uint32_t alignment)
+    {
+        if (size == 0)
+            throw std::logic_error("`RangeAllocator` doesn't support zero-sized allocations.");
+        if (alignment == 0)
+            throw std::logic_error("`RangeAllocator` alignment can't be zero.");
+
+        // Find the smallest range that fits. We don't know the padding in advance, so we might have to look at several ranges.
+        // But any range at least `size + alignment - 1` large always fits, so this terminates quickly.
+        for (auto iter = state.free_by_size.lower_bound({size, 0}); iter != state.free_by_size.end(); ++iter)
+        {
+            auto [block_size, block_offset] = *iter;
+
+            std::uint32_t padding = (alignment - block_offset % alignment) % alignment;
+            if (std::uint64_t(padding) + size > block_size)
+                continue;
+
+            RemoveFreeRange(state.free_by_offset.find(block_offset));
+
+            // Give the unused tail back. The padding stays in the block, since it's usually too small to be useful,
+            //   and keeping it there avoids fragmenting the free list.
+            std::uint32_t used_size = padding + size;
+            AddFreeRange(block_offset + used_size, block_size - used_size);
+
+            std::uint32_t offset = block_offset + padding;
+            state.allocated.try_emplace(offset, Block{.offset = block_offset, .size = used_size});
+            state.used_bytes += used_size;
+            return offset;
+        }
+
+        return std::nullopt;
+    }
+
+    void RangeAllocator::Free(std::uint32_t offset)
+    {
+        auto iter = state.allocated.find(offset);
+        if (iter == state.allocated.end())
+            throw std::logic_error(fmt::format("Attempt to free a range at offset {} that wasn't allocated by this `RangeAllocator`.", offset));
+
+        Block block = iter->second;
+        state.allocated.erase(iter);
+        state.used_bytes -= block.size;
+        AddFreeRange(block.offset, block.size);
+    }
+
+    void RangeAllocator::Clear()
+    {
+        *this = RangeAllocator(state.capacity);
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <gtl/phmap.hpp>
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <set>
+#include <utility>
+
+namespace em
+{
+    // Allocates subranges of `[0, capacity)`, e.g. for suballocating a large GPU buffer. Doesn't own any memory by itself.
+    // Uses a best-fit free list, merging the adjacent free ranges when freeing. Everything is logarithmic in the number of ranges.
+    class RangeAllocator
+    {
+        // The actual range we took from the free list, which can be larger than requested because of the alignment.
+        struct Block
+        {
+            std::uint32_t offset = 0;
+            std::uint32_t size = 0;
+        };
+
+        struct State
+        {
+            std::uint32_t capacity = 0;
+            std::uint32_t used_bytes = 0;
+
+            // Offset -> size.
+            std::map<std::uint32_t, std::uint32_t> free_by_offset;
+            // `{size, offset}`, for the best fit search. This mirrors `free_by_offset`.
+            std::set<std::pair<std::uint32_t, std::uint32_t>> free_by_size;
+
+            // The offset returned by `Allocate()` -> the block we took for it.
+            gtl::flat_hash_map<std::uint32_t, Block> allocated;
+        };
+        State state;
+
+        void AddFreeRange(std::uint32_t offset, std::uint32_t size);
+        void RemoveFreeRange(std::map<std::uint32_t, std::uint32_t>::iterator iter);
+
+      public:
+        RangeAllocator() {}
+
+        explicit RangeAllocator(std::uint32_t capacity);
+
+        RangeAllocator(RangeAllocator &&other) noexcept
+            : state(std::move(other.state))
+        {
+            other.state = {};
+        }
+        RangeAllocator &operator=(RangeAllocator other) noexcept
+        {
+            std::swap(state, other.state);
+            return *this;
+        }
+
+        [[nodiscard]] std::uint32_t Capacity() const {return state.capacity;}
+        // Includes the alignment padding.
+        [[nodiscard]] std::uint32_t UsedBytes() const {return state.used_bytes;}
+        [[nodiscard]] std::uint32_t NumAllocations() const {return std::uint32_t(state.allocated.size());}
+        [[nodiscard]] std::uint32_t NumFreeRanges() const {return std::uint32_t(state.free_by_offset.size());}
+
+        // Returns the offset of the allocated range, or null if there's no free range large enough.
+        // `alignment` doesn't have to be a power of two. Zero-sized allocations are not allowed.
+        [[nodiscard]] std::optional<std::uint32_t> Allocate(std::uint32_t size, std::uint32_t alignment = 1);
+
+        // Frees a range returned by `Allocate()`. Throws if there's no allocation with this offset.
+        void Free(std::uint32_t offset);
+
+        // Frees everything.
+        void Clear();
+    };
+}
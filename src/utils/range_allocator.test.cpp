@@ -0,0 +1,84 @@
+#include "utils/range_allocator.h"
+
+#include "em/minitest.hpp"
+
+using namespace em;
+
+EM_TEST( range_allocator_basic )
+{
+    RangeAllocator a(100);
+
+    EM_CHECK_SOFT(a.Allocate(10) == 0);
+    EM_CHECK_SOFT(a.Allocate(20) == 10);
+    EM_CHECK_SOFT(a.Allocate(70) == 30);
+    EM_CHECK_SOFT(a.Allocate(1) == std::nullopt);
+    EM_CHECK_SOFT(a.UsedBytes() == 100);
+
+    // Free the middle range and allocate into it again.
+    a.Free(10);
+    EM_CHECK_SOFT(a.UsedBytes() == 80);
+    EM_CHECK_SOFT(a.Allocate(21) == std::nullopt);
+    EM_CHECK_SOFT(a.Allocate(15) == 10);
+    EM_CHECK_SOFT(a.Allocate(5) == 25);
+
+    EM_MUST_THROW( a.Free(42) )(std::logic_error("Attempt to free a range at offset 42 that wasn't allocated by this `RangeAllocator`."));
+    EM_MUST_THROW( (void)a.Allocate(0) )(std::logic_error("`RangeAllocator` doesn't support zero-sized allocations."));
+}
+
+EM_TEST( range_allocator_merging )
+{
+    RangeAllocator a(30);
+    EM_CHECK_SOFT(a.Allocate(10) == 0);
+    EM_CHECK_SOFT(a.Allocate(10) == 10);
+    EM_CHECK_SOFT(a.Allocate(10) == 20);
+
+    // Free in an order that requires merging with both neighbors.
+    a.Free(0);
+    a.Free(20);
+    EM_CHECK_SOFT(a.NumFreeRanges() == 2);
+    a.Free(10);
+    EM_CHECK_SOFT(a.NumFreeRanges() == 1);
+    EM_CHECK_SOFT(a.UsedBytes() == 0);
+
+    EM_CHECK_SOFT(a.Allocate(30) == 0);
+}
+
+EM_TEST( range_allocator_best_fit )
+{
+    RangeAllocator a(100);
+    EM_CHECK_SOFT(a.Allocate(10) == 0);
+    EM_CHECK_SOFT(a.Allocate(30) == 10);
+    EM_CHECK_SOFT(a.Allocate(10) == 40);
+    EM_CHECK_SOFT(a.Allocate(5) == 50);
+    EM_CHECK_SOFT(a.Allocate(10) == 55);
+    // Free ranges: [10,40) of size 30, [50,55) of size 5, [65,100) of size 35.
+    a.Free(10);
+    a.Free(50);
+
+    // Should pick the smallest range that fits.
+    EM_CHECK_SOFT(a.Allocate(4) == 50);
+    EM_CHECK_SOFT(a.Allocate(30) == 10);
+    EM_CHECK_SOFT(a.Allocate(35) == 65);
+}
+
+EM_TEST( range_allocator_alignment )
+{
+    RangeAllocator a(100);
+    EM_CHECK_SOFT(a.Allocate(3) == 0);
+    EM_CHECK_SOFT(a.Allocate(8, 8) == 8);
+    EM_CHECK_SOFT(a.Allocate(6, 6) == 18); // Non-power-of-two alignment.
+    EM_CHECK_SOFT(a.UsedBytes() == 24); // The padding counts as used.
+
+    // Freeing returns the padding too.
+    a.Free(8);
+    a.Free(18);
+    a.Free(0);
+    EM_CHECK_SOFT(a.UsedBytes() == 0);
+    EM_CHECK_SOFT(a.NumFreeRanges() == 1);
+
+    // Doesn't fit because of the padding.
+    RangeAllocator b(10);
+    EM_CHECK_SOFT(b.Allocate(1) == 0);
+    EM_CHECK_SOFT(b.Allocate(8, 4) == std::nullopt);
+    EM_CHECK_SOFT(b.Allocate(6, 4) == 4);
+}
@@ -0,0 +1,96 @@
+#include "thread_pool.h"
+
+#include "utils/process.h"
+
+#include <stdexcept>
+
+namespace em
+{
+    namespace
+    {
+        // The `ThreadPool::Shared` of the pool that owns the current thread, if any.
+        thread_local const void *current_thread_pool = nullptr;
+    }
+
+    void ThreadPool::ThreadFunc(Shared &shared)
+    {
+        current_thread_pool = &shared;
+
+        std::unique_lock lock(shared.mutex);
+
+        while (true)
+        {
+            shared.task_added.wait(lock, [&]{return shared.stop || !shared.tasks.empty();});
+
+            // Finish the remaining tasks even when stopping.
+            if (shared.tasks.empty())
+                return;
+
+            std::function<void()> task = std::move(shared.tasks.front());
+            shared.tasks.pop_front();
+            shared.num_running++;
+
+            lock.unlock();
+            task();
+            lock.lock();
+
+            shared.num_running--;
+            if (shared.num_running == 0 && shared.tasks.empty())
+                shared.became_idle.notify_all();
+        }
+    }
+
+    ThreadPool::ThreadPool(int num_threads)
+    {
+        if (num_threads < 0)
+            throw std::logic_error("The number of threads in a `ThreadPool` can't be negative.");
+        if (num_threads == 0)
+            num_threads = Process::NumCpuCores();
+
+        state.shared = std::make_unique<Shared>();
+        state.threads.reserve(std::size_t(num_threads));
+        for (int i = 0; i < num_threads; i++)
+            state.threads.emplace_back(ThreadFunc, std::ref(*state.shared));
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        if (!state.shared)
+            return;
+
+        {
+            std::lock_guard lock(state.shared->mutex);
+            state.shared->stop = true;
+        }
+        state.shared->task_added.notify_all();
+
+        // Join before `shared` is destroyed.
+        state.threads.clear();
+    }
+
+    void ThreadPool::Run(std::function<void()> func)
+    {
+        if (!*this)
+            throw std::logic_error("Attempt to use a null `ThreadPool`.");
+
+        {
+            std::lock_guard lock(state.shared->mutex);
+            state.shared->tasks.push_back(std::move(func));
+        }
+        state.shared->task_added.notify_one();
+    }
+
+    void ThreadPool::WaitUntilIdle()
+    {
+        if (!*this)
+            return;
+
+        std::unique_lock lock(state.shared->mutex);
+        state.shared->became_idle.wait(lock, [&]{return state.shared->num_running == 0 && state.shared->tasks.empty();});
+    }
+
+    bool ThreadPool::IsCurrentThreadInPool() const
+    {
+        return state.shared && current_thread_pool == state.shared.get();
+    }
+}
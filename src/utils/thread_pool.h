@@ -0,0 +1,78 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace em
+{
+    // A fixed set of worker threads that run the submitted functions in the submission order.
+    class ThreadPool
+    {
+        // This is stored by pointer, since the threads refer to it, and the pool must stay movable.
+        struct Shared
+        {
+            std::mutex mutex;
+
+            // Notified when a task is added or when stopping.
+            std::condition_variable task_added;
+            // Notified when the last running task finishes and the queue is empty.
+            std::condition_variable became_idle;
+
+            std::deque<std::function<void()>> tasks;
+            // The number of tasks that were taken from `tasks`, but haven't finished yet.
+            std::size_t num_running = 0;
+
+            bool stop = false;
+        };
+
+        struct State
+        {
+            std::unique_ptr<Shared> shared;
+            std::vector<std::jthread> threads;
+        };
+        State state;
+
+        static void ThreadFunc(Shared &shared);
+
+      public:
+        constexpr ThreadPool() {}
+
+        // If `num_threads` is zero, uses the number of CPU cores.
+        explicit ThreadPool(int num_threads);
+
+        ThreadPool(ThreadPool &&other) noexcept
+            : state(std::move(other.state))
+        {
+            other.state = {};
+        }
+        ThreadPool &operator=(ThreadPool other) noexcept
+        {
+            std::swap(state, other.state);
+            return *this;
+        }
+
+        // Finishes all the queued tasks before returning.
+        ~ThreadPool();
+
+        [[nodiscard]] explicit operator bool() const {return bool(state.shared);}
+
+        [[nodiscard]] int NumThreads() const {return int(state.threads.size());}
+
+        // Queues a function to run on one of the threads.
+        // The function must not throw. If you need the exception, catch it in the function and save it as an `std::exception_ptr`.
+        void Run(std::function<void()> func);
+
+        // Blocks until all queued tasks finish.
+        void WaitUntilIdle();
+
+        // Returns true if called from one of the threads of this pool.
+        // Use this to avoid deadlocks, since a task that waits for other tasks of the same pool can end up waiting for itself.
+        [[nodiscard]] bool IsCurrentThreadInPool() const;
+    };
+}
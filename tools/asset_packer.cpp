@@ -0,0 +1,142 @@
+// Packs a directory into an `AssetArchive` (see `src/utils/asset_archive.h`).
+// Usage: asset-packer --input <dir> --output <file> [--compress] [--alignment <n>] [--raw-images]
+// The entry names are the paths relative to the input directory, with `/` as the separator.
+// `--raw-images` converts PNG and JPG images to the raw format (see `Image::EncodeRaw()`), which loads much faster. The names stay the same,
+//   since `Image` detects the format from the contents. Combine this with `--compress` to keep the size reasonable.
+
+#include "command_line/parser.h"
+#include "errors/exception_analyzer.h"
+#include "utils/asset_archive.h"
+#include "utils/filesystem.h"
+#include "utils/image.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    using namespace em;
+
+    // Compressing those again is a waste of time.
+    [[nodiscard]] bool IsAlreadyCompressed(std::string_view filename)
+    {
+        static constexpr std::array<std::string_view, 6> extensions = {".png", ".jpg", ".jpeg", ".ogg", ".mp3", ".zip"};
+        return std::any_of(extensions.begin(), extensions.end(), [&](std::string_view ext){return filename.ends_with(ext);});
+    }
+
+    [[nodiscard]] bool IsConvertibleImage(std::string_view filename)
+    {
+        return filename.ends_with(".png") || filename.ends_with(".jpg") || filename.ends_with(".jpeg");
+    }
+
+    struct Options
+    {
+        bool compress = false;
+        bool raw_images = false;
+    };
+
+    void AddDirectory(AssetArchiveWriter &writer, const std::string &dir, const std::string &prefix, const Options &options)
+    {
+        std::vector<std::string> filenames;
+        Filesystem::VisitDirectory(dir, [&](zstring_view filename)
+        {
+            filenames.emplace_back(filename);
+            return false;
+        });
+        // Sort to make the archives reproducible, `VisitDirectory()` doesn't do it.
+        std::sort(filenames.begin(), filenames.end());
+
+        for (const std::string &filename : filenames)
+        {
+            const std::string path = fmt::format("{}/{}", dir, filename);
+            const std::string name = prefix + filename;
+
+            auto info = Filesystem::GetFileInfo(path);
+            if (!info)
+                throw std::runtime_error(fmt::format("Unable to get information about `{}`.", path));
+
+            if (info->kind == Filesystem::FileKind::directory)
+            {
+                AddDirectory(writer, path, name + "/", options);
+            }
+            else if (info->kind == Filesystem::FileKind::file)
+            {
+                // Reading the files sequentially, since we only touch them once.
+                blob_or_file data(path, Filesystem::FileLoadParams{.access_hint = Filesystem::FileAccessHint::sequential});
+
+                if (options.raw_images && IsConvertibleImage(filename))
+                {
+                    auto raw = std::make_shared<std::vector<unsigned char>>(Image(path, data).EncodeRaw());
+                    writer.Add(name, blob(std::shared_ptr<const unsigned char[]>(raw, raw->data()), raw->size()), options.compress);
+                }
+                else
+                {
+                    writer.Add(name, std::move(data), options.compress && !IsAlreadyCompressed(filename));
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        std::string input_dir;
+        std::string output_path;
+        Options options;
+        AssetArchiveWriter::Params params;
+
+        CommandLine::Parser parser;
+        parser.AddDefaultHelpFlag();
+        parser.AddFlag<std::string>("-i,--input", {}, "dir", "The directory to pack.", [&](std::string dir){input_dir = std::move(dir);});
+        parser.AddFlag<std::string>("-o,--output", {}, "file", "The archive file to write.", [&](std::string path){output_path = std::move(path);});
+        parser.AddFlag("--compress", {}, "Compress the files, except for the already compressed formats.", [&]{options.compress = true;});
+        parser.AddFlag("--raw-images", {}, "Convert PNG and JPG images to the raw format, which loads faster.", [&]{options.raw_images = true;});
+        parser.AddFlag<std::string>(
+            "--alignment",
+            {},
+            "n",
+            fmt::format("The alignment of every file in the archive, a power of two. Defaults to {}.", params.alignment),
+            [&](const std::string &value)
+            {
+                std::uint32_t alignment = 0;
+                auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), alignment);
+                if (ec != std::errc{} || ptr != value.data() + value.size() || !std::has_single_bit(alignment))
+                    throw std::runtime_error(fmt::format("The alignment must be a power of two, but got `{}`.", value));
+                params.alignment = alignment;
+            }
+        );
+        parser.Parse(argc, argv);
+
+        if (input_dir.empty() || output_path.empty())
+            throw std::runtime_error("Must specify `--input` and `--output`. See `--help`.");
+
+        while (input_dir.size() > 1 && (input_dir.back() == '/' || input_dir.back() == '\\'))
+            input_dir.pop_back();
+
+        AssetArchiveWriter writer(params);
+        AddDirectory(writer, input_dir, "", options);
+        writer.Save(output_path);
+
+        fmt::print("Packed {} files into `{}`.\n", writer.NumEntries(), output_path);
+        return 0;
+    }
+    catch (...)
+    {
+        fmt::print(stderr, "Error: {}\n", DefaultExceptionAnalyzer().Analyze(std::current_exception()).CombinedMessage());
+        return 1;
+    }
+}
@@ -0,0 +1,71 @@
+// Compresses an image into a `Gpu::CompressedImage` (see `src/gpu/compressed_image.h`), with a mipmap chain.
+// Usage: texture-encoder --input <image> --output <file> [--format bc1|bc3] [--no-mipmaps] [--fast]
+// `AssetLoader::LoadTexture()` detects those files from the contents, so they can be put into asset archives under any name.
+
+#include "command_line/parser.h"
+#include "errors/exception_analyzer.h"
+#include "gpu/compressed_image.h"
+#include "utils/filesystem.h"
+#include "utils/image.h"
+
+#include <fmt/format.h>
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    using namespace em;
+
+    try
+    {
+        std::string input_path;
+        std::string output_path;
+        Gpu::CompressedImage::EncodeParams params;
+
+        CommandLine::Parser parser;
+        parser.AddDefaultHelpFlag();
+        parser.AddFlag<std::string>("-i,--input", {}, "file", "The image to compress.", [&](std::string path){input_path = std::move(path);});
+        parser.AddFlag<std::string>("-o,--output", {}, "file", "The compressed image file to write.", [&](std::string path){output_path = std::move(path);});
+        parser.AddFlag<std::string>(
+            "-f,--format",
+            {},
+            "name",
+            "`bc3` (the default) keeps the full alpha channel, `bc1` is half the size but only for opaque images.",
+            [&](const std::string &name)
+            {
+                if (name == "bc1")
+                    params.format = Gpu::CompressedImage::EncodeFormat::bc1;
+                else if (name == "bc3")
+                    params.format = Gpu::CompressedImage::EncodeFormat::bc3;
+                else
+                    throw std::runtime_error(fmt::format("Unknown format `{}`, expected `bc1` or `bc3`.", name));
+            }
+        );
+        parser.AddFlag("--no-mipmaps", {}, "Don't generate the mipmaps.", [&]{params.generate_mipmaps = false;});
+        parser.AddFlag("--fast", {}, "Compress faster, at the cost of quality.", [&]{params.high_quality = false;});
+        parser.Parse(argc, argv);
+
+        if (input_path.empty() || output_path.empty())
+            throw std::runtime_error("Must specify `--input` and `--output`. See `--help`.");
+
+        Image image(input_path, input_path);
+        std::vector<unsigned char> bytes = Gpu::CompressedImage::Encode(image, params);
+
+        Filesystem::File file(output_path, "wb");
+        if (std::fwrite(bytes.data(), bytes.size(), 1, file.Handle()) != 1)
+            throw std::runtime_error(fmt::format("Unable to write the compressed image to `{}`.", output_path));
+
+        fmt::print("Compressed `{}` ({}x{}, {} bytes uncompressed) into `{}` ({} bytes).\n",
+            input_path, image.pixels.size().x, image.pixels.size().y, image.pixels.flat_size() * sizeof(u8vec4), output_path, bytes.size());
+        return 0;
+    }
+    catch (...)
+    {
+        fmt::print(stderr, "Error: {}\n", DefaultExceptionAnalyzer().Analyze(std::current_exception()).CombinedMessage());
+        return 1;
+    }
+}